@@ -0,0 +1,82 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "rasterizer.hpp"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    /** \brief Moves bar heights the way the filtered spectrum does: fast attacks and a steady fall
+     *
+     * The bars are laid out like rescale_rects does for a single panel.
+     */
+    void animate(std::vector<visualize::rasterizer::rect> &bars, std::mt19937 &rng, int width, int height) {
+        std::uniform_real_distribution<double> jump(0, 1);
+        auto count = int(bars.size());
+        int w = width / count;
+        for (int i = 0; i < count; i++) {
+            auto &bar = bars[size_t(i)];
+            int h = bar.h;
+            if (jump(rng) < 0.1) {
+                h = int(jump(rng) * height);
+            } else {
+                h = std::max(h - height / 60, 0);
+            }
+            bar = { width % count / 2 + i * w, height - h, w, h };
+        }
+    }
+
+    /** \brief Renders \p frames frames into a \p width x \p height buffer
+     *
+     * \param incremental Whether to keep the previous frame, otherwise every frame starts from a clear like
+     * SDL_RenderClear + SDL_RenderFillRects do
+     * \return frames per second
+     */
+    double run(int width, int height, size_t barcount, size_t frames, bool incremental) {
+        auto pixels = std::make_unique<uint32_t[]>(size_t(width) * size_t(height));
+        visualize::rasterizer raster(0xffffffff, 0xff000000);
+        raster.target(pixels.get(), size_t(width), width, height);
+        std::vector<visualize::rasterizer::rect> bars(barcount, { 0, 0, 0, 0 }), dirty;
+        std::mt19937 rng(1);
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < frames; i++) {
+            animate(bars, rng, width, height);
+            if (!incremental) {
+                raster.target(pixels.get(), size_t(width), width, height);
+            }
+            raster.draw(bars.data(), bars.size(), dirty);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return double(frames) / elapsed.count();
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    int width = 3840, height = 2160;
+    size_t frames = argc > 1 ? std::stoul(argv[1]) : 2000;
+    for (size_t barcount : { 160, 960 }) {
+        auto full = run(width, height, barcount, frames, false);
+        auto incremental = run(width, height, barcount, frames, true);
+        std::cout << width << "x" << height << ", " << barcount << " bars: " << full << " fps full redraw, "
+                  << incremental << " fps incremental" << std::endl;
+    }
+}
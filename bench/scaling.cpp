@@ -0,0 +1,85 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "data_sources/generator.hpp"
+#include "filters/clip_filter.hpp"
+#include "filters/peek_filter.hpp"
+#include "filters/sagc_filter.hpp"
+#include "pipeline.hpp"
+#include "worker_pool.hpp"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    /** \brief Steps a pipeline with the live filter chain on unpaced noise for \p frames frames
+     *
+     * \param threads 1 for the serial pipeline, otherwise the pool size and fftw thread count
+     * \return frames per second
+     */
+    double run(size_t resolution, size_t threads, size_t chunk_bins, size_t frames) {
+        visualize::generator_source::settings settings;
+        settings.kind = visualize::generator_source::signal::white_noise;
+        std::vector<std::unique_ptr<visualize::filter>> filters;
+        filters.emplace_back(new visualize::sagc_filter(resolution));
+        filters.emplace_back(new visualize::clip_filter(resolution));
+        filters.emplace_back(new visualize::peek_filter(resolution, 100.0 / 6.0));
+
+        // the stepping thread takes chunks too, so it's one of the threads
+        std::unique_ptr<visualize::worker_pool> pool;
+        visualize::parallel_options parallel;
+        if (threads > 1) {
+            pool = std::make_unique<visualize::worker_pool>(threads - 1);
+            parallel.pool = pool.get();
+            parallel.fft_threads = int(threads);
+            parallel.chunk_bins = chunk_bins;
+        }
+        visualize::pipeline pipe(resolution,
+                                 std::make_unique<visualize::generator_source>(resolution * 2, settings),
+                                 std::move(filters), parallel);
+        // warm up caches and fftw's threads
+        for (size_t i = 0; i < 10; i++) {
+            pipe.step();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < frames; i++) {
+            pipe.step();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return double(frames) / elapsed.count();
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t frames = argc > 1 ? std::stoul(argv[1]) : 200;
+    size_t chunk_bins = argc > 2 ? std::stoul(argv[2]) : 4096;
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t resolution : { 65536, 262144, 1048576 }) {
+        double serial = 0;
+        for (size_t threads = 1; threads <= cores; threads *= 2) {
+            auto fps = run(resolution, threads, chunk_bins, frames);
+            if (threads == 1) {
+                serial = fps;
+            }
+            std::cout << "resolution " << resolution << ", " << threads << " threads: " << fps << " frames/s, "
+                      << fps / serial << "x" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,73 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef COMPACT_FRAME_HPP
+#define COMPACT_FRAME_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace visualize {
+    enum class compact_format {
+        //! frames are kept as doubles
+        none,
+        //! 16 bit codes linear in the magnitude, error at most scale / 131070
+        linear16,
+        //! 8 bit codes logarithmic in the magnitude over \p log8_range_db, relative error at most ~2.2%
+        log8
+    };
+
+    //! dynamic range of \p compact_format::log8, magnitudes further below the frame's scale become 0
+    constexpr double log8_range_db = 96;
+
+    /** \brief A frame of non-negative magnitudes quantized relative to its largest element
+     *
+     * Display needs far less precision than a double carries, so handing frames over in this form moves 4x
+     * (\p linear16) or 8x (\p log8) fewer bytes between threads or to storage.
+     */
+    struct compact_frame {
+        explicit compact_frame(compact_format format = compact_format::linear16) : format(format) {}
+
+        //! quantizes \p size elements of \p data, negative elements are treated as 0
+        void pack(const double *data, size_t size);
+        //! writes the \p size() dequantized elements to \p data
+        void unpack(double *data) const;
+
+        size_t size() const { return format == compact_format::log8 ? log.size() : linear.size(); }
+        //! size of the codes and the scale, in bytes
+        size_t bytes() const {
+            return sizeof(scale) + (format == compact_format::log8 ? log.size() : linear.size() * 2);
+        }
+
+        compact_format format;
+        //! largest element of the packed frame
+        float scale = 0;
+        std::vector<uint16_t> linear;
+        std::vector<uint8_t> log;
+    };
+
+    /** \brief Quantizes \p size magnitudes to 16 bit codes relative to \p scale
+     *
+     * \p pack_linear16 and \p unpack_linear16 are the SIMD kernels behind \p compact_format::linear16
+     */
+    void pack_linear16(const double *data, size_t size, double scale, uint16_t *codes);
+    void unpack_linear16(const uint16_t *codes, size_t size, double scale, double *data);
+    void pack_log8(const double *data, size_t size, double scale, uint8_t *codes);
+    void unpack_log8(const uint8_t *codes, size_t size, double scale, double *data);
+} // namespace visualize
+
+#endif // COMPACT_FRAME_HPP
@@ -39,6 +39,8 @@ namespace visualize {
          * \returns \p false if retreival failed. The program is preticted to exit if data retreival fails.
          */
         bool grab_audio(double *output);
+        //! false if the source could not be opened, \p grab_audio fails then
+        virtual bool good() const { return true; }
 
     private:
         /** \brief Synchronously grabs unprocessed audio from the server.
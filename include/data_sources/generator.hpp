@@ -0,0 +1,82 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include "../data_source.hpp"
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace visualize {
+    //! Deterministic synthetic signals, for load generation and known-frequency fixtures
+    struct generator_source : public data_source {
+        enum class signal { silence, sine, sweep, multitone, white_noise, pink_noise, impulse };
+
+        struct settings {
+            signal kind = signal::sine;
+            double sample_rate = 44100;
+            double amplitude = 0.5;
+            //! frequency of \p sine, start frequency of \p sweep
+            double frequency = 1000;
+            //! end frequency of \p sweep, the sweep is logarithmic and restarts once it reaches this
+            double frequency_end = 20000;
+            //! seconds one \p sweep takes
+            double sweep_duration = 10;
+            //! frequencies of \p multitone, each at \p amplitude divided by the tone count
+            std::vector<double> tones = { 100, 1000, 10000 };
+            //! seconds between two \p impulse samples
+            double impulse_interval = 0.5;
+            //! seed for the noise signals
+            uint32_t seed = 1;
+            //! block until the produced audio would have been captured by a live source, otherwise produce as fast as
+            //! possible
+            bool paced = false;
+            //! samples to produce before grabbing fails, 0 for no limit
+            size_t length = 0;
+        };
+
+        generator_source(size_t buffer_len, settings config);
+
+        //! samples produced so far
+        size_t position() const { return produced; }
+        /** \brief Grabs that started more than one block behind schedule
+         *
+         * A live source would have dropped audio in these, only counted when \p paced is set.
+         */
+        size_t overruns() const { return late; }
+
+    private:
+        bool do_grab_audio(double *output) override;
+        double next_sample();
+
+        size_t buffer_len;
+        settings config;
+        std::mt19937 rng;
+        std::uniform_real_distribution<double> uniform { -1.0, 1.0 };
+
+        size_t produced = 0;
+        size_t late = 0;
+        double phase = 0;
+        std::vector<double> tone_phases;
+        //! state of the pink noise filter
+        double pink[7] = {};
+        std::chrono::steady_clock::time_point start;
+    };
+} // namespace visualize
+
+#endif // GENERATOR_HPP
@@ -22,15 +22,30 @@
 
 namespace visualize {
     struct pulseaudio_source : public data_source {
-        pulseaudio_source(size_t buffer_len);
+        /** \brief Connects to the PulseAudio server
+         *
+         * \param buffer_len Samples per grab
+         * \param device Name of the source to record from (e.g. a sink monitor), nullptr selects the default source
+         * \param latency_budget Recording latency, in microseconds, above which the backlog is dropped so capture
+         * skips ahead to live audio. 0 never skips
+         */
+        pulseaudio_source(size_t buffer_len, const char *device = nullptr, pa_usec_t latency_budget = 0);
         ~pulseaudio_source() override;
         // disable copy
         pulseaudio_source(const pulseaudio_source &) = delete;
         pulseaudio_source &operator=(const pulseaudio_source &) = delete;
 
+        //! false if the connection to the server or the device failed, grabbing audio fails then
+        bool good() const override { return bool(simple); }
+
+        //! times the backlog exceeded the latency budget and was dropped
+        size_t skips() const { return skipped; }
+
     private:
         bool do_grab_audio(double *output) override;
         size_t buffer_len;
+        pa_usec_t latency_budget;
+        size_t skipped = 0;
         pa_simple *simple = nullptr;
         std::unique_ptr<int16_t[]> pulse_buffer;
     };
@@ -0,0 +1,75 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef WAV_HPP
+#define WAV_HPP
+
+#include "../data_source.hpp"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace visualize {
+    /** \brief Streams samples out of a RIFF WAVE file
+     *
+     * Supports 8, 16, 24 and 32 bit integer PCM and 32 bit float data with any channel count, channels are mixed
+     * together. Only \p hop new frames are read per grab, the remainder of the window is kept from previous grabs.
+     */
+    struct wav_source : public data_source {
+        /** \brief Opens \p path and parses its header
+         *
+         * \param path File to read
+         * \param buffer_len Samples per grab
+         * \param hop Frames the window advances per grab, 0 means \p buffer_len. Frames skipped by hops larger than
+         * \p buffer_len are read but never windowed.
+         */
+        wav_source(const std::string &path, size_t buffer_len, size_t hop = 0);
+
+        //! false if the file could not be opened or parsed, grabbing will fail
+        bool good() const override { return valid; }
+        uint32_t sample_rate() const { return rate; }
+        size_t hop_size() const { return hop; }
+        //! changes the hop of the following grabs, e.g. to follow a frame rate that isn't a divisor of the sample rate
+        void set_hop(size_t frames) { hop = frames == 0 ? buffer_len : frames; }
+        //! frames consumed so far
+        size_t position() const { return frames_read; }
+
+    private:
+        bool do_grab_audio(double *output) override;
+        bool parse_header();
+        double decode(const char *sample) const;
+
+        size_t buffer_len;
+        size_t hop;
+        std::ifstream file;
+        std::string path;
+
+        uint16_t format = 0;
+        uint16_t channels = 0;
+        uint32_t rate = 0;
+        uint16_t bits = 0;
+        uint16_t block_align = 0;
+        size_t data_left = 0;
+        size_t frames_read = 0;
+        bool valid = false;
+
+        std::vector<char> raw;
+        std::vector<double> window;
+        bool primed = false;
+    };
+} // namespace visualize
+
+#endif // WAV_HPP
@@ -0,0 +1,113 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FEATURES_HPP
+#define FEATURES_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace visualize {
+    //! features of one frame, published together with its magnitudes
+    struct spectral_features {
+        static constexpr size_t band_count = 8;
+
+        //! summed increase of the magnitudes over the previous frame, per bin
+        double flux = 0;
+        //! magnitude weighted mean bin, as a fraction of the spectrum (0 is dc, 1 is nyquist)
+        double centroid = 0;
+        //! summed squared magnitudes in logarithmically spaced bands, lowest band first
+        std::array<double, band_count> band_energy {};
+        //! flux rose above the adaptive threshold in this frame
+        bool onset = false;
+        //! tempo estimated from recent onsets, 0 until enough onsets were seen
+        double bpm = 0;
+    };
+
+    /** \brief Computes spectral features while the magnitudes are being produced
+     *
+     * Every bin is passed to \p accumulate right after its magnitude is calculated, so the features need no extra
+     * pass over the spectrum. \p finish then only does per-frame work.
+     */
+    struct feature_tracker {
+        //! \param bins Magnitudes per frame
+        explicit feature_tracker(size_t bins);
+
+        //! running sums of a frame, or of some of its bins
+        struct sums {
+            double flux = 0, weighted = 0, total = 0;
+            std::array<double, spectral_features::band_count> energy {};
+        };
+
+        //! starts a new frame
+        void begin() { frame = sums(); }
+
+        void accumulate(size_t bin, double magnitude) { accumulate(frame, bin, magnitude); }
+
+        /** \brief Like the above, into separate sums that are added to the frame with \p merge
+         *
+         * Disjoint bins may be accumulated concurrently, each thread into its own sums.
+         */
+        void accumulate(sums &into, size_t bin, double magnitude) {
+            auto &previous = last[bin];
+            into.flux += magnitude > previous ? magnitude - previous : 0;
+            previous = magnitude;
+            into.weighted += double(bin) * magnitude;
+            into.total += magnitude;
+            into.energy[band_of[bin]] += magnitude * magnitude;
+        }
+
+        void merge(const sums &part) {
+            frame.flux += part.flux;
+            frame.weighted += part.weighted;
+            frame.total += part.total;
+            for (size_t band = 0; band < frame.energy.size(); band++) {
+                frame.energy[band] += part.energy[band];
+            }
+        }
+
+        /** \brief Completes the frame and runs onset and tempo detection
+         *
+         * \param time Time of the frame in seconds, only differences between frames matter
+         */
+        const spectral_features &finish(double time);
+
+    private:
+        //! frames of flux history the onset threshold is computed from
+        static constexpr size_t history_len = 43;
+        //! onsets kept for tempo estimation
+        static constexpr size_t onset_len = 32;
+
+        void estimate_tempo();
+
+        size_t bins;
+        std::unique_ptr<double[]> last;
+        std::unique_ptr<uint8_t[]> band_of;
+
+        sums frame;
+
+        std::array<double, history_len> history {};
+        size_t history_pos = 0, history_count = 0;
+        std::array<double, onset_len> onsets {};
+        size_t onset_pos = 0, onset_count = 0;
+
+        spectral_features current;
+    };
+} // namespace visualize
+
+#endif // FEATURES_HPP
@@ -29,12 +29,30 @@ namespace visualize {
          */
         void apply(double *output);
 
+        /** \brief Applies filter to the elements [\p begin, \p end) of \p output
+         *
+         * Only available if \p partitionable. A frame may be split into any number of disjoint ranges, which may be
+         * applied concurrently. Afterwards \p reduce is called once with the sum of the values they returned, the
+         * result of which may only affect later frames.
+         *
+         * \return This range's share of the frame's reduction, e.g. a partial sum of squares
+         */
+        double apply_range(double *output, size_t begin, size_t end);
+        //! completes a frame applied through \p apply_range
+        void reduce(double total);
+        //! whether the filter can be applied in ranges
+        bool partitionable() const;
+
     private:
         /** \brief Applies filter to \p output
          *
          * \param output Data buffer to apply to
          */
         virtual void do_apply(double *output) = 0;
+        //! only called on \p partitionable filters
+        virtual double do_apply_range(double *output, size_t begin, size_t end);
+        virtual void do_reduce(double total);
+        virtual bool do_partitionable() const;
     };
 } // namespace visualize
 
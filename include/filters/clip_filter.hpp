@@ -25,6 +25,8 @@ namespace visualize {
 
     private:
         void do_apply(double *data) override;
+        double do_apply_range(double *data, size_t begin, size_t end) override;
+        bool do_partitionable() const override { return true; }
 
         size_t buffer_size;
     };
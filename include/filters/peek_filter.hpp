@@ -26,6 +26,8 @@ namespace visualize {
 
     private:
         void do_apply(double *data) override;
+        double do_apply_range(double *data, size_t begin, size_t end) override;
+        bool do_partitionable() const override { return true; }
 
         std::unique_ptr<double[]> peeks;
         size_t data_size;
@@ -25,6 +25,10 @@ namespace visualize {
 
     private:
         void do_apply(double *data) override;
+        //! returns the range's share of the mean square, \p do_reduce adapts the gain to the frame's
+        double do_apply_range(double *data, size_t begin, size_t end) override;
+        void do_reduce(double rms) override;
+        bool do_partitionable() const override { return true; }
 
         size_t data_size;
         double gain = 1.0;
@@ -0,0 +1,143 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FRAME_QUEUE_HPP
+#define FRAME_QUEUE_HPP
+
+#include "compact_frame.hpp"
+#include "features.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace visualize {
+    //! one published array of magnitudes or bars
+    struct frame {
+        uint64_t sequence = 0;
+        std::chrono::steady_clock::time_point captured;
+        //! features of the spectrum \p data was computed from
+        spectral_features features;
+        std::vector<double> data;
+    };
+
+    //! what a \p frame_queue does when a frame arrives while it's full
+    enum class overflow_policy {
+        //! the producer waits for the consumer, nothing is lost. for offline rendering
+        block,
+        //! the oldest queued frame is discarded
+        drop_oldest,
+        //! the incoming frame is merged into the newest queued one, keeping the per-element maximum
+        coalesce_max,
+        //! the incoming frame is merged into the newest queued one, keeping the per-element mean of all merged frames
+        coalesce_mean,
+        //! like \p drop_oldest, and \p pop skips straight to the newest frame whenever the consumer fell behind
+        catch_up
+    };
+
+    /** \brief Bounded FIFO of frames between one producer and one consumer thread
+     *
+     * All slots are allocated up front and frames are copied in and out of them, so nothing is allocated once the
+     * queue is running. With a \p compact_format the slots hold quantized frames instead, which are packed by the
+     * producer and unpacked by the consumer outside the lock. Coalescing merges outside the lock as well, so no
+     * frame is copied, packed or unpacked while the other side could be waiting.
+     */
+    struct frame_queue {
+        //! how often each path was taken
+        struct counters {
+            uint64_t pushed = 0;
+            uint64_t popped = 0;
+            //! pushes that had to wait for the consumer
+            uint64_t blocked = 0;
+            //! frames discarded by \p drop_oldest and \p catch_up on push
+            uint64_t dropped = 0;
+            //! frames merged into another one
+            uint64_t coalesced = 0;
+            //! frames passed over by \p catch_up on pop
+            uint64_t skipped = 0;
+            //! payload bytes stored by \p push
+            uint64_t bytes = 0;
+        };
+
+        /** \param capacity Frames the queue holds before \p policy kicks in
+         * \param frame_size Elements per frame
+         * \param format How frames are stored, \p pop hands out the dequantized values for anything but \p none
+         */
+        frame_queue(size_t capacity, size_t frame_size, overflow_policy policy = overflow_policy::block,
+                    compact_format format = compact_format::none);
+
+        frame_queue(const frame_queue &) = delete;
+        frame_queue &operator=(const frame_queue &) = delete;
+
+        /** \brief Appends a frame of \p frame_size elements, applying the overflow policy while the queue is full
+         *
+         * A frame coalesced into another one passes on its features, keeping an onset of the one it was merged into.
+         *
+         * \return false if the queue was closed, the frame is discarded.
+         */
+        bool push(const double *data, uint64_t sequence, std::chrono::steady_clock::time_point captured,
+                  const spectral_features &features = spectral_features());
+        /** \brief Takes the oldest frame, blocks while the queue is empty
+         *
+         * \param out Receives the frame, its \p data is resized to \p frame_size
+         * \return false once the queue is closed and drained.
+         */
+        bool pop(frame &out);
+        /** \brief Like \p pop, but returns false right away if no frame is queued
+         *
+         * For consumers with their own pace, e.g. a render loop that keeps showing the previous frame.
+         */
+        bool try_pop(frame &out);
+        //! wakes up both sides, \p push fails from now on and \p pop once the remaining frames are taken
+        void close();
+
+        counters stats();
+
+        const size_t frame_size;
+        const overflow_policy policy;
+        const compact_format format;
+
+    private:
+        void take(frame &out);
+        //! merges \p data into the frame taken out of the newest slot, \p frames counts \p data as well
+        void merge(const double *data, size_t frames);
+        //! a frame is queued that the consumer may take
+        bool ready() const { return count > size_t(merging); }
+
+        std::vector<frame> slots;
+        //! slot payloads in compact mode, \p slots then only carry the sequence and capture time
+        std::vector<compact_frame> packed;
+        //! owned by the producer and the consumer respectively, swapped with a slot under the lock
+        compact_frame incoming, outgoing;
+        //! owned by the producer, the newest slot's frame while it's coalesced into
+        std::vector<double> scratch;
+        //! frames merged into each slot, for the running mean
+        std::vector<size_t> merged;
+        size_t head = 0;
+        size_t count = 0;
+        bool closed = false;
+        //! the newest slot is out for \p merge, it's the last queued one so the consumer only gets to it afterwards
+        bool merging = false;
+        counters counts;
+
+        std::mutex lock;
+        std::condition_variable not_empty, not_full;
+    };
+} // namespace visualize
+
+#endif // FRAME_QUEUE_HPP
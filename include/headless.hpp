@@ -0,0 +1,77 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef HEADLESS_HPP
+#define HEADLESS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace visualize {
+    //! settings of a headless render, see \p render_headless
+    struct headless_options {
+        enum class format {
+            //! packed 24 bit RGB frames, back to back
+            rgb,
+            //! YUV4MPEG2 with 4:4:4 chroma, readable by ffmpeg and most encoders
+            y4m,
+            //! one binary PPM image per frame
+            ppm
+        };
+
+        //! WAV file to visualize
+        std::string input;
+        format output_format = format::y4m;
+        /** \brief "-" for stdout, otherwise a file name
+         *
+         * for \p ppm this is a pattern taking the frame number, e.g. "frame%06d.ppm", see \p expand_frame_pattern
+         */
+        std::string output = "-";
+        int width = 1920;
+        int height = 1080;
+        int fps = 60;
+        //! analysed frames buffered between the analysis and the render thread
+        size_t queue_frames = 16;
+
+        size_t resolution = 2048;
+        size_t barcount = 160;
+        double gravity = 100.0 / 6.0;
+        //! 0xRRGGBB
+        uint32_t foreground = 0xffffff;
+        uint32_t background = 0x000000;
+    };
+
+    /** \brief Renders the bars of \p options.input at a fixed frame rate, without a display
+     *
+     * The file is analysed as fast as possible, one window per video frame, on a separate thread from the rasterizer
+     * and the encoder. Progress and errors go to stderr, as stdout may carry the video.
+     *
+     * \return the process exit code
+     */
+    int render_headless(const headless_options &options);
+
+    /** \brief Puts the frame \p number into a file name pattern
+     *
+     * The pattern holds exactly one `%d`, optionally with a width (`%6d`) or zero padded (`%06d`), and `%%` for a
+     * literal percent sign. It's never used as a printf format.
+     *
+     * \return false if \p pattern isn't of that form, \p name is unspecified then.
+     */
+    bool expand_frame_pattern(const std::string &pattern, int number, std::string &name);
+} // namespace visualize
+
+#endif // HEADLESS_HPP
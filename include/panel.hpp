@@ -0,0 +1,49 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef PANEL_HPP
+#define PANEL_HPP
+
+#include "data_source.hpp"
+#include "frame_queue.hpp"
+#include "pipeline.hpp"
+#include "worker_pool.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace visualize {
+    //! one analysed source: its pipeline, the queue to the consumer and whether it's still scheduled
+    struct panel {
+        std::unique_ptr<pipeline> pipe;
+        std::unique_ptr<frame_queue> queue;
+        //! the source \p pipe owns
+        data_source *src = nullptr;
+        //! as configured, empty for the default source
+        std::string device;
+        //! cleared when a reload replaces the panel or its source fails, the pipeline isn't stepped afterwards
+        std::atomic_bool active = true;
+    };
+
+    /** \brief steps the pipeline of \p target on \p pool until it's retired or \p run is cleared
+     *
+     * the task resubmits itself after every block and holds on to the panel, so a retired panel is destroyed once
+     * its last step has finished. a failing source only retires its own panel, the others keep running
+     */
+    void schedule(worker_pool &pool, std::shared_ptr<panel> target, std::atomic_bool &run);
+} // namespace visualize
+
+#endif // PANEL_HPP
@@ -0,0 +1,132 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include "data_source.hpp"
+#include "features.hpp"
+#include "filter.hpp"
+#include "frame_queue.hpp"
+#include "postprocessing.hpp"
+#include "realtime.hpp"
+#include "worker_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <fftw3.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace visualize {
+    /** \brief Opt-in splitting of each frame's work, for resolutions too large for one thread to keep up with
+     *
+     * The defaults keep everything on the thread that steps the pipeline.
+     */
+    struct parallel_options {
+        //! threads fftw_execute spreads the transform over, ignored if fftw was built without thread support
+        int fft_threads = 1;
+        /** \brief Pool the work after the transform is spread over, nullptr to keep it on the stepping thread
+         *
+         * The stepping thread takes chunks as well and never waits for one that hasn't started, so the pipeline may
+         * be stepped from a task of the same pool. Only workers that are asleep are asked to help, with none free the
+         * stepping thread does every chunk itself.
+         */
+        worker_pool *pool = nullptr;
+        //! bins per chunk. a chunk's spectrum, magnitudes and filter state take ~40 bytes a bin and should fit in L2
+        size_t chunk_bins = 4096;
+    };
+
+    //! One independent analysis chain: data source -> fftw -> filters -> published buffer
+    struct pipeline {
+        /** \brief Sets up the chain and plans its transform
+         *
+         * \param resolution Size of the fftw output, the source has to produce twice as many samples
+         * \param src Source of the samples, owned by the pipeline
+         * \param filters Filters applied, in order, to the magnitudes before publication
+         * \param parallel How the work of a frame is split up. With a pool, magnitudes, features and the leading
+         * \p filter::partitionable filters are computed chunk by chunk, the remaining filters run afterwards
+         */
+        pipeline(size_t resolution, std::unique_ptr<data_source> src, std::vector<std::unique_ptr<filter>> filters,
+                 const parallel_options &parallel = parallel_options());
+        ~pipeline();
+
+        pipeline(const pipeline &) = delete;
+        pipeline &operator=(const pipeline &) = delete;
+
+        /** \brief Grabs one block of audio, transforms it and publishes the filtered magnitudes to \p output
+         *
+         * \return false if the source failed. The pipeline shall not be stepped again afterwards.
+         */
+        bool step();
+
+        const jitter_histogram &jitter() const { return wakeup_jitter; }
+
+        /** \brief Sets the rate at which the source delivers blocks, used to time the features
+         *
+         * Sources that deliver faster than real time (files, unpaced generators) need this. Otherwise, and with 0,
+         * frames are timed by the clock.
+         */
+        void set_frame_rate(double rate) { frame_rate = rate; }
+
+        /** \brief Additionally pushes every published frame into \p queue, nullptr to stop
+         *
+         * Unlike \p output, which only ever holds the latest frame, the queue's overflow policy decides what happens
+         * to frames the consumer didn't get to. The queue has to hold \p resolution elements per frame.
+         */
+        void set_output_queue(frame_queue *queue) { this->queue = queue; }
+
+        /** \brief Replaces the filter chain, may be called from any thread
+         *
+         * The new chain takes over at the start of the next \p step, so no frame is filtered by a mix of both. The
+         * old one is destroyed by the next call or together with the pipeline, not on the thread that steps it.
+         */
+        void set_filters(std::vector<std::unique_ptr<filter>> filters);
+
+        //! latest filtered magnitudes, \p resolution elements
+        visualize::buffer output;
+
+    private:
+        //! state shared with the tasks working on chunks of a frame, outlives the pipeline if a task does
+        struct chunk_work;
+
+        //! magnitudes, features and the first \p partitioned filters of chunk \p index, see \p parallel_options
+        void process_chunk(size_t index);
+        //! splits the current frame across the pool and waits for it, returns how many filters were applied
+        size_t process_chunks(double *data);
+
+        std::unique_ptr<data_source> src;
+        std::vector<std::unique_ptr<filter>> filters;
+        //! chain waiting for \p step to pick it up, afterwards the one it replaced
+        std::vector<std::unique_ptr<filter>> next_filters;
+        std::atomic_bool filters_changed = false;
+        std::mutex filters_lock;
+        std::unique_ptr<double[]> fftw_in;
+        std::unique_ptr<fftw_complex[]> fftw_out;
+        fftw_plan plan;
+
+        feature_tracker features;
+        std::shared_ptr<chunk_work> chunks;
+        double frame_rate = 0;
+        frame_queue *queue = nullptr;
+
+        jitter_histogram wakeup_jitter;
+        std::chrono::steady_clock::time_point first_wakeup, last_wakeup;
+        bool first_step = true;
+    };
+} // namespace visualize
+
+#endif // PIPELINE_HPP
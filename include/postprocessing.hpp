@@ -18,8 +18,10 @@
 #define POSTPROCESSING_HPP
 
 #include "data_source.hpp"
+#include "features.hpp"
 #include "filter.hpp"
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -38,6 +40,12 @@ namespace visualize {
         buffer &operator=(buffer &&) = delete;
 
         const size_t data_size;
+        //! number of frames published into the buffer so far, only valid while the buffer is acquired
+        uint64_t sequence = 0;
+        //! when the audio of the latest frame was captured, only valid while the buffer is acquired
+        std::chrono::steady_clock::time_point captured;
+        //! features of the latest frame, computed from the unfiltered magnitudes, only valid while acquired
+        spectral_features features;
 
     private:
         std::unique_ptr<double[]> data;
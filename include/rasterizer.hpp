@@ -0,0 +1,71 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef RASTERIZER_HPP
+#define RASTERIZER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace visualize {
+    /** \brief Draws bars on the CPU straight into a 32 bit pixel buffer
+     *
+     * The rasterizer remembers where every bar was drawn last frame and only rewrites the rows between its old and
+     * its new top, so a frame costs roughly the change in bar heights instead of a clear of the whole target.
+     */
+    struct rasterizer {
+        //! same layout as SDL_Rect
+        struct rect {
+            int x, y, w, h;
+        };
+
+        /** \param foreground Pixel value of the bars, in the format of the target
+         * \param background Pixel value everywhere else
+         */
+        rasterizer(uint32_t foreground, uint32_t background);
+
+        /** \brief Points the rasterizer at a new pixel buffer and clears it to the background
+         *
+         * \param pixels First pixel of the buffer
+         * \param pitch Distance between two rows, in pixels
+         */
+        void target(uint32_t *pixels, size_t pitch, int width, int height);
+
+        /** \brief Draws \p count bars, bar i covering \p bars[i]
+         *
+         * Bars that keep their column and bottom edge are updated incrementally, anything else is erased and redrawn.
+         *
+         * \param dirty Replaced by the areas that were written, to be passed on to e.g. SDL_UpdateWindowSurfaceRects
+         */
+        void draw(const rect *bars, size_t count, std::vector<rect> &dirty);
+
+    private:
+        //! fills the part of \p area inside the target, returns that part
+        rect fill(const rect &area, uint32_t color);
+
+        uint32_t foreground, background;
+        uint32_t *pixels = nullptr;
+        size_t pitch = 0;
+        int width = 0, height = 0;
+        std::vector<rect> previous;
+    };
+
+    //! sets \p count pixels starting at \p row to \p color
+    void fill_row(uint32_t *row, size_t count, uint32_t color);
+} // namespace visualize
+
+#endif // RASTERIZER_HPP
@@ -0,0 +1,85 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef REALTIME_HPP
+#define REALTIME_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <sched.h>
+
+namespace visualize {
+    /** \brief Moves the calling thread into a real-time scheduling class
+     *
+     * If the requested priority exceeds the RLIMIT_RTPRIO grant of an unprivileged user, it is clamped to the grant.
+     *
+     * \param policy \p SCHED_FIFO or \p SCHED_RR
+     * \param priority Static priority, see sched(7)
+     * \return false if the thread stays in its old scheduling class, prints the reason.
+     */
+    bool set_realtime_priority(int policy, int priority);
+
+    /** \brief Pins the calling thread to a single CPU
+     *
+     * \param cpu Zero-based CPU index, negative values are a no-op
+     * \return false on failure, prints the error message.
+     */
+    bool pin_thread(int cpu);
+
+    /** \brief Locks all current and future pages of the process in memory
+     *
+     * \return false on failure (usually RLIMIT_MEMLOCK), prints the error message.
+     */
+    bool lock_memory();
+
+    /** \brief Touches \p size bytes of the calling thread's stack
+     *
+     * Together with \p lock_memory this keeps page faults out of the steady state of a thread.
+     */
+    void prefault_stack(size_t size);
+
+    //! Histogram of thread wakeup jitter, bucketed by powers of two microseconds
+    struct jitter_histogram {
+        /** \brief Records one iteration of a periodic thread
+         *
+         * The period is estimated as the running mean of \p interval. Iterations whose \p busy time exceeds it have
+         * missed their deadline: the next buffer was complete before the previous one was published.
+         *
+         * \param interval Time since the previous wakeup
+         * \param busy Time spent processing after this wakeup
+         */
+        void record(std::chrono::nanoseconds interval, std::chrono::nanoseconds busy);
+        void print(std::ostream &os) const;
+
+        uint64_t samples() const { return count; }
+        uint64_t missed_deadlines() const { return missed; }
+
+    private:
+        //! the last bucket collects everything above 2^(bucket_count - 2) microseconds
+        static constexpr size_t bucket_count = 20;
+
+        std::array<uint64_t, bucket_count> buckets {};
+        uint64_t count = 0;
+        uint64_t missed = 0;
+        double mean_interval = 0;
+        std::chrono::nanoseconds worst {};
+    };
+} // namespace visualize
+
+#endif // REALTIME_HPP
@@ -0,0 +1,188 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef SETTINGS_HPP
+#define SETTINGS_HPP
+
+#include "compact_frame.hpp"
+#include "frame_queue.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <sched.h>
+#include <string>
+#include <vector>
+
+namespace visualize {
+    struct color {
+        uint8_t r, g, b;
+
+        bool operator==(const color &other) const { return r == other.r && g == other.g && b == other.b; }
+        bool operator!=(const color &other) const { return !(*this == other); }
+    };
+
+    /** \brief Runtime configuration of the visualizer
+     *
+     * Read from a file of `key = value` lines, see \p read_settings. Every member's name is its key.
+     */
+    struct settings {
+        /** \brief speed of peek reduction
+         * gravity is defined to be 1000 * peek_reduction_per_sample
+         */
+        double gravity = 100.0 / 6.0;
+
+        /** \brief number of bars to display on screen
+         *
+         * best results are achieved by using fullscreen and having
+         * \code
+         *  screen_width = n * barcount
+         * \endcode
+         * where n is a positive integer
+         */
+        size_t barcount = 160;
+        /** \brief size of fftw output
+         *
+         * the amount of samples taken for each fftw input is twice the amount of output
+         */
+        size_t resolution = 2048;
+        //! window background color, `#rrggbb`
+        color background = { 0, 0, 0 };
+        //! bar foreground color, `#rrggbb`
+        color foreground = { 255, 255, 255 };
+
+        /** \brief devices to analyse, comma separated. one pipeline and panel is created for each
+         *
+         * for pulse they name a source or a sink monitor (see `pactl list short sources`), an empty name or `default`
+         * selects the default source
+         */
+        std::vector<std::string> devices = { "" };
+        /** \brief worker threads shared by all pipelines, 0 for one per device
+         *
+         * blocking sources occupy a worker while they wait for data, so fewer workers than devices serializes reads
+         */
+        size_t workers = 0;
+
+        bool fullscreen = false;
+        //! wait for vertical sync when presenting through an SDL_Renderer
+        bool vsync = true;
+
+        /** \brief run the audio workers with a real-time scheduling policy
+         *
+         * requires CAP_SYS_NICE or an RLIMIT_RTPRIO grant (e.g. via /etc/security/limits.conf), falls back to normal
+         * scheduling otherwise. a wakeup jitter histogram is printed on exit.
+         */
+        bool realtime = false;
+        //! `fifo` or `rr`
+        int realtime_policy = SCHED_FIFO;
+        int realtime_priority = 10;
+        //! lock and pre-fault memory so page faults can't delay the audio workers (only with \p realtime)
+        bool lock_memory = true;
+        /** \brief CPUs to pin the workers and the render thread to, -1 to leave them unpinned
+         *
+         * worker n gets audio_cpu + n, workers past the last CPU stay unpinned
+         */
+        int audio_cpu = -1;
+        int render_cpu = -1;
+
+        /** \brief draw the bars on the CPU straight into the window surface instead of through an SDL_Renderer
+         *
+         * only the rows that changed since the last frame are written and presented. this is also used when no
+         * renderer can be created, e.g. on machines without a GPU
+         */
+        bool software_rendering = false;
+        //! frame rate cap of software rendering, which has no vsync to wait on
+        int software_fps = 60;
+
+        //! frames queued between each pipeline and the renderer
+        size_t handoff_frames = 2;
+        /** \brief what happens to frames the renderer can't keep up with (minimized window, vsync hiccups)
+         *
+         * `block`, `drop_oldest`, `coalesce_max`, `coalesce_mean` or `catch_up`. coalescing with the maximum keeps
+         * short peaks visible, catch_up has the lowest latency
+         */
+        overflow_policy handoff_policy = overflow_policy::coalesce_max;
+        /** \brief how frames are stored on their way to the renderer, `none`, `linear16` or `log8`
+         *
+         * linear16 is exact to well below a pixel at any window height and moves a quarter of the bytes, log8 an
+         * eighth at ~2% relative error. none keeps the doubles
+         */
+        compact_format handoff_format = compact_format::linear16;
+        //! recording latency in microseconds after which capture drops its backlog and skips ahead, 0 to never skip
+        uint64_t latency_budget = 200000;
+
+        /** \brief spread the work after each transform over the workers, for resolutions of 65536 and more
+         *
+         * with \p workers at 0 there is one worker per core instead of one per device. every worker runs under
+         * \p realtime, so with it set the visualizer can keep all cores busy at real-time priority
+         */
+        bool parallel = false;
+        //! threads each transform is spread over, needs fftw with thread support
+        int fft_threads = 1;
+        //! bins per chunk of \p parallel work, see \p parallel_options
+        size_t chunk_bins = 4096;
+
+        /** \brief Parses \p value into the member named \p key
+         *
+         * \param error Set to the reason on failure
+         * \return false for unknown keys and malformed values, the settings are unchanged.
+         */
+        bool set(const std::string &key, const std::string &value, std::string &error);
+        //! checks the members against each other, \p error is set to the first problem found
+        bool validate(std::string &error) const;
+        //! whether \p key names a member
+        static bool known(const std::string &key);
+    };
+
+    /** \brief Applies the `key = value` lines of \p in to \p out
+     *
+     * Blank lines and lines starting with `#` are skipped, keys missing from the input keep their value.
+     *
+     * \param name Used in error messages
+     * \return false if a line could not be applied or the result doesn't validate, prints the error message.
+     */
+    bool read_settings(std::istream &in, const std::string &name, settings &out);
+    //! like the above, for a file
+    bool read_settings(const std::string &path, settings &out);
+
+    /** \brief Reports when a file is written or replaced, via inotify
+     *
+     * The containing directory is watched, so editors that save by renaming a new file over the old one are seen
+     * as well, and a file created after the watch is seen once it has been written and closed.
+     */
+    struct file_watcher {
+        explicit file_watcher(const std::string &path);
+        ~file_watcher();
+
+        file_watcher(const file_watcher &) = delete;
+        file_watcher &operator=(const file_watcher &) = delete;
+
+        //! false if the watch could not be set up, the error has been printed
+        bool good() const { return fd >= 0; }
+
+        /** \brief Waits up to \p timeout for the file to change
+         *
+         * \return true if it changed, all events queued up to then are consumed.
+         */
+        bool wait(std::chrono::milliseconds timeout);
+
+    private:
+        std::string name;
+        int fd = -1;
+    };
+} // namespace visualize
+
+#endif // SETTINGS_HPP
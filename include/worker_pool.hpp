@@ -0,0 +1,85 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace visualize {
+    /** \brief Fixed set of threads, each with its own task deque
+     *
+     * Workers take tasks from the back of their own deque and, once it runs dry, steal from the front of the other
+     * workers' deques. Tasks submitted from inside a worker stay on that worker, so a task that resubmits itself
+     * keeps its data in the same cache until another worker goes idle.
+     */
+    struct worker_pool {
+        /** \brief Starts \p threads workers
+         *
+         * \param threads Worker count, at least one worker is always started
+         * \param on_start Called on each worker thread with its index before it takes any tasks
+         */
+        explicit worker_pool(size_t threads, std::function<void(size_t)> on_start = {});
+        //! finishes queued tasks and joins the workers
+        ~worker_pool();
+
+        worker_pool(const worker_pool &) = delete;
+        worker_pool &operator=(const worker_pool &) = delete;
+
+        void submit(std::function<void()> task);
+        /** \brief Submits \p task only if a sleeping worker is left to take it
+         *
+         * Meant for optional help with work the caller does itself as well. A plain \p submit from a busy worker
+         * stays in its deque until a worker goes idle, which never happens while every worker runs a task that
+         * resubmits itself.
+         *
+         * \return false if every worker is busy or already woken for another task, \p task is dropped then
+         */
+        bool try_submit(std::function<void()> task);
+        size_t size() const { return workers.size(); }
+        //! tasks submitted but not yet taken by a worker
+        size_t queued() const;
+
+    private:
+        struct worker {
+            std::deque<std::function<void()>> tasks;
+            std::mutex lock;
+        };
+
+        void run(size_t index);
+        bool pop(size_t index, std::function<void()> &task);
+
+        std::vector<std::unique_ptr<worker>> workers;
+        std::vector<std::thread> threads;
+        std::atomic_size_t next_worker = 0;
+
+        mutable std::mutex sleep_lock;
+        std::condition_variable wakeup;
+        size_t pending = 0;
+        //! workers waiting for a task, including those woken that haven't taken their reservation yet
+        size_t idle = 0;
+        bool stopping = false;
+    };
+} // namespace visualize
+
+#endif // WORKER_POOL_HPP
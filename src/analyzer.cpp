@@ -0,0 +1,282 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compact_frame.hpp"
+#include "data_sources/wav.hpp"
+#include "filters/clip_filter.hpp"
+#include "filters/peek_filter.hpp"
+#include "filters/sagc_filter.hpp"
+#include "pipeline.hpp"
+#include "postprocessing.hpp"
+#include "worker_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct options {
+        size_t resolution = 2048;
+        size_t barcount = 160;
+        //! frames between the starts of consecutive windows, 0 for non-overlapping windows
+        size_t hop = 0;
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        double gravity = 100.0 / 6.0;
+        //! skip the filter chain and output plain magnitudes
+        bool raw = false;
+        //! write binary frames instead of csv
+        bool binary = false;
+        //! quantization of binary frames, none for float32
+        visualize::compact_format compact = visualize::compact_format::none;
+        //! also write the spectral features of every frame
+        bool features = false;
+        //! split the work of each frame across the workers as well, see \p visualize::parallel_options
+        bool parallel = false;
+        int fft_threads = 1;
+        std::filesystem::path output_dir = ".";
+        std::vector<std::string> files;
+    };
+
+    void usage(const char *argv0) {
+        std::cerr << "usage: " << argv0 << " [options] file.wav...\n"
+                  << "  -r <n>    fftw output resolution (default 2048)\n"
+                  << "  -b <n>    bars per frame (default 160)\n"
+                  << "  -H <n>    hop size in frames (default: resolution * 2, no overlap)\n"
+                  << "  -j <n>    files analysed in parallel (default: one per core)\n"
+                  << "  -g <n>    peek filter gravity (default 16.67)\n"
+                  << "  -o <dir>  output directory (default .)\n"
+                  << "  --raw     skip the filters, output plain magnitudes\n"
+                  << "  --binary  write binary frames instead of csv\n"
+                  << "  --compact <linear16|log8>  write quantized binary frames\n"
+                  << "  --features  also write <file>.features.csv: time, flux, centroid, onset, bpm and band\n"
+                  << "              energies\n"
+                  << "  --parallel  also split every frame across the -j workers, for few files at a large -r\n"
+                  << "  --fft-threads <n>  threads each transform is spread over (default 1)\n"
+                  << "\n"
+                  << "csv output has one line per frame: the frame time in seconds followed by the bars.\n"
+                  << "binary output starts with the magic \"VBAR\", a uint32 version (1), a uint32 bar count and a\n"
+                  << "float32 frame rate, followed by frames of float32 bars. all values use native byte order.\n"
+                  << "--compact writes version 2, whose header has an additional uint32 format (1 linear16, 2 log8)\n"
+                  << "and whose frames are a float32 scale, the largest bar, followed by one code per bar. linear16\n"
+                  << "codes are uint16 with bar = code / 65535 * scale, log8 codes are uint8 with bar = 0 for 0 and\n"
+                  << "scale * 10^(-(255 - code) * 96 / 254 / 20) otherwise."
+                  << std::endl;
+    }
+
+    bool parse_args(int argc, char **argv, options &opts) try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            auto value = [&]() -> const char * { return i + 1 < argc ? argv[++i] : nullptr; };
+            const char *v = nullptr;
+            if (arg == "--raw") {
+                opts.raw = true;
+            } else if (arg == "--binary") {
+                opts.binary = true;
+            } else if (arg == "--compact" && (v = value())) {
+                if (std::strcmp(v, "linear16") == 0) {
+                    opts.compact = visualize::compact_format::linear16;
+                } else if (std::strcmp(v, "log8") == 0) {
+                    opts.compact = visualize::compact_format::log8;
+                } else {
+                    return false;
+                }
+                opts.binary = true;
+            } else if (arg == "--features") {
+                opts.features = true;
+            } else if (arg == "--parallel") {
+                opts.parallel = true;
+            } else if (arg == "--fft-threads" && (v = value())) {
+                opts.fft_threads = std::stoi(v);
+            } else if (arg == "-r" && (v = value())) {
+                opts.resolution = std::stoul(v);
+            } else if (arg == "-b" && (v = value())) {
+                opts.barcount = std::stoul(v);
+            } else if (arg == "-H" && (v = value())) {
+                opts.hop = std::stoul(v);
+            } else if (arg == "-j" && (v = value())) {
+                opts.threads = std::stoul(v);
+            } else if (arg == "-g" && (v = value())) {
+                opts.gravity = std::stod(v);
+            } else if (arg == "-o" && (v = value())) {
+                opts.output_dir = v;
+            } else if (!arg.empty() && arg[0] != '-') {
+                opts.files.push_back(arg);
+            } else {
+                return false;
+            }
+        }
+        // outputs are named after the input's file name, so inputs from different directories could collide and be
+        // written concurrently by two workers
+        std::map<std::filesystem::path, std::string> targets;
+        for (auto &file : opts.files) {
+            auto [existing, inserted] = targets.emplace(std::filesystem::path(file).filename(), file);
+            if (!inserted) {
+                std::cerr << existing->second << " and " << file << " would write the same output files" << std::endl;
+                return false;
+            }
+        }
+        return !opts.files.empty() && opts.resolution > 0 && opts.barcount > 0 && opts.fft_threads > 0
+               && opts.barcount <= opts.resolution;
+    } catch (const std::logic_error &) {
+        // std::stoul and std::stod throw on malformed numbers
+        return false;
+    }
+
+    /** \brief Runs \p path through its own pipeline and writes the bar frames next to it in the output directory
+     *
+     * \param pool Workers the frames are split across with \p options::parallel
+     * \param audio_seconds Set to the amount of audio analysed
+     * \return false if the file could not be read or the output could not be written
+     */
+    bool analyse(const std::string &path, const options &opts, visualize::worker_pool &pool, double &audio_seconds) {
+        auto src = std::make_unique<visualize::wav_source>(path, opts.resolution * 2, opts.hop);
+        if (!src->good()) {
+            return false;
+        }
+        auto &wav = *src;
+        auto frame_rate = double(wav.sample_rate()) / double(wav.hop_size());
+
+        std::vector<std::unique_ptr<visualize::filter>> filters;
+        if (!opts.raw) {
+            filters.emplace_back(new visualize::sagc_filter(opts.resolution));
+            filters.emplace_back(new visualize::clip_filter(opts.resolution));
+            filters.emplace_back(new visualize::peek_filter(opts.resolution, opts.gravity));
+        }
+        visualize::parallel_options parallel;
+        parallel.fft_threads = opts.fft_threads;
+        if (opts.parallel) {
+            parallel.pool = &pool;
+        }
+        visualize::pipeline pipe(opts.resolution, std::move(src), std::move(filters), parallel);
+        pipe.set_frame_rate(frame_rate);
+
+        auto target = opts.output_dir / std::filesystem::path(path).filename();
+        target += opts.binary ? ".bars" : ".bars.csv";
+        std::ofstream out(target, opts.binary ? std::ios::binary : std::ios::out);
+        if (!out) {
+            std::cerr << "Could not open " << target << " for writing" << std::endl;
+            return false;
+        }
+        std::ofstream features;
+        if (opts.features) {
+            auto features_target = opts.output_dir / std::filesystem::path(path).filename();
+            features_target += ".features.csv";
+            features.open(features_target);
+            if (!features) {
+                std::cerr << "Could not open " << features_target << " for writing" << std::endl;
+                return false;
+            }
+        }
+        if (opts.binary) {
+            auto compact = opts.compact != visualize::compact_format::none;
+            uint32_t header[] = { compact ? 2u : 1u, uint32_t(opts.barcount) };
+            auto rate = float(frame_rate);
+            out.write("VBAR", 4);
+            out.write(reinterpret_cast<const char *>(header), sizeof(header));
+            out.write(reinterpret_cast<const char *>(&rate), sizeof(rate));
+            if (compact) {
+                uint32_t format = opts.compact == visualize::compact_format::linear16 ? 1 : 2;
+                out.write(reinterpret_cast<const char *>(&format), sizeof(format));
+            }
+        }
+
+        auto bars = std::make_unique<double[]>(opts.barcount);
+        auto frame = std::make_unique<float[]>(opts.barcount);
+        visualize::compact_frame packed(opts.compact);
+        for (size_t n = 0; pipe.step(); n++) {
+            visualize::spectral_features frame_features;
+            {
+                auto [data, _] = pipe.output.acquire();
+                visualize::calculate_bars(bars.get(), opts.barcount, data, pipe.output.data_size);
+                frame_features = pipe.output.features;
+            }
+            if (opts.features) {
+                features << double(n) / frame_rate << ',' << frame_features.flux << ','
+                         << frame_features.centroid << ',' << frame_features.onset << ',' << frame_features.bpm;
+                for (auto energy : frame_features.band_energy) {
+                    features << ',' << energy;
+                }
+                features << '\n';
+            }
+            if (opts.compact != visualize::compact_format::none) {
+                packed.pack(bars.get(), opts.barcount);
+                out.write(reinterpret_cast<const char *>(&packed.scale), sizeof(packed.scale));
+                if (opts.compact == visualize::compact_format::linear16) {
+                    out.write(reinterpret_cast<const char *>(packed.linear.data()),
+                              std::streamsize(packed.linear.size() * sizeof(uint16_t)));
+                } else {
+                    out.write(reinterpret_cast<const char *>(packed.log.data()), std::streamsize(packed.log.size()));
+                }
+            } else if (opts.binary) {
+                std::copy_n(bars.get(), opts.barcount, frame.get());
+                out.write(reinterpret_cast<const char *>(frame.get()), std::streamsize(opts.barcount * sizeof(float)));
+            } else {
+                out << double(n) / frame_rate;
+                for (size_t i = 0; i < opts.barcount; i++) {
+                    out << ',' << float(bars[i]);
+                }
+                out << '\n';
+            }
+        }
+        audio_seconds = double(wav.position()) / double(wav.sample_rate());
+        if (!out.flush() || (opts.features && !features.flush())) {
+            std::cerr << "Could not write " << target << std::endl;
+            return false;
+        }
+        return true;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    options opts;
+    if (!parse_args(argc, argv, opts)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<double> audio_seconds(opts.files.size());
+    std::atomic_size_t failed = 0;
+    {
+        // each file gets its own pipeline, and therefore its own plan, on whichever worker picks it up
+        visualize::worker_pool pool(opts.parallel ? opts.threads : std::min(opts.threads, opts.files.size()));
+        for (size_t i = 0; i < opts.files.size(); i++) {
+            pool.submit([&, i]() {
+                if (!analyse(opts.files[i], opts, pool, audio_seconds[i])) {
+                    std::cerr << "Failed to analyse " << opts.files[i] << std::endl;
+                    failed++;
+                }
+            });
+        }
+    }
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+
+    double total = 0;
+    for (auto seconds : audio_seconds) {
+        total += seconds;
+    }
+    std::cout << "Analysed " << opts.files.size() - failed << " of " << opts.files.size() << " files, "
+              << total / 3600 << " h of audio in " << wall.count() << " s: " << (total / 3600) / (wall.count() / 60)
+              << " audio-hours per minute" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "compact_frame.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+    constexpr double linear16_max = 65535;
+    //! width of one log8 code in dB, code 0 is reserved for silence
+    constexpr double log8_step_db = visualize::log8_range_db / 254;
+
+    //! magnitude relative to the scale for each log8 code
+    const std::array<double, 256> &log8_levels() {
+        static const auto levels = []() {
+            std::array<double, 256> table{};
+            for (size_t code = 1; code < table.size(); code++) {
+                table[code] = std::pow(10.0, -double(255 - code) * log8_step_db / 20);
+            }
+            return table;
+        }();
+        return levels;
+    }
+} // namespace
+
+void visualize::pack_linear16(const double *data, size_t size, double scale, uint16_t *codes) {
+    if (scale <= 0) {
+        std::fill_n(codes, size, uint16_t(0));
+        return;
+    }
+    auto factor = linear16_max / scale;
+    size_t i = 0;
+#ifdef __SSE2__
+    auto wide_factor = _mm_set1_pd(factor);
+    auto zero = _mm_setzero_pd(), top = _mm_set1_pd(linear16_max);
+    // there's no unsigned saturating 32 -> 16 bit pack before SSE4.1, so the codes are biased into the signed range
+    // for _mm_packs_epi32 and flipped back afterwards
+    auto bias = _mm_set1_epi32(32768);
+    auto flip = _mm_set1_epi16(short(0x8000));
+    for (; i + 4 <= size; i += 4) {
+        auto lo = _mm_min_pd(_mm_max_pd(_mm_mul_pd(_mm_loadu_pd(&data[i]), wide_factor), zero), top);
+        auto hi = _mm_min_pd(_mm_max_pd(_mm_mul_pd(_mm_loadu_pd(&data[i + 2]), wide_factor), zero), top);
+        // cvtpd rounds to nearest under the default rounding mode, like std::lrint below
+        auto words = _mm_unpacklo_epi64(_mm_cvtpd_epi32(lo), _mm_cvtpd_epi32(hi));
+        words = _mm_sub_epi32(words, bias);
+        auto packed = _mm_xor_si128(_mm_packs_epi32(words, words), flip);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(&codes[i]), packed);
+    }
+#endif
+    for (; i < size; i++) {
+        codes[i] = uint16_t(std::lrint(std::clamp(data[i] * factor, 0.0, linear16_max)));
+    }
+}
+
+void visualize::unpack_linear16(const uint16_t *codes, size_t size, double scale, double *data) {
+    auto factor = scale / linear16_max;
+    size_t i = 0;
+#ifdef __SSE2__
+    auto wide_factor = _mm_set1_pd(factor);
+    auto zero = _mm_setzero_si128();
+    for (; i + 4 <= size; i += 4) {
+        auto words = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(&codes[i])), zero);
+        _mm_storeu_pd(&data[i], _mm_mul_pd(_mm_cvtepi32_pd(words), wide_factor));
+        _mm_storeu_pd(&data[i + 2], _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(words, 8)), wide_factor));
+    }
+#endif
+    for (; i < size; i++) {
+        data[i] = codes[i] * factor;
+    }
+}
+
+void visualize::pack_log8(const double *data, size_t size, double scale, uint8_t *codes) {
+    if (scale <= 0) {
+        std::fill_n(codes, size, uint8_t(0));
+        return;
+    }
+    // codes are rounded in the dB domain, so everything below half a step under the lowest level is silence
+    auto floor = scale * std::pow(10.0, -(log8_range_db + log8_step_db / 2) / 20);
+    auto inverse = 1 / scale;
+    for (size_t i = 0; i < size; i++) {
+        if (!(data[i] > floor)) {
+            codes[i] = 0;
+            continue;
+        }
+        auto below = -20 * std::log10(data[i] * inverse) / log8_step_db;
+        codes[i] = uint8_t(255 - std::clamp(std::lrint(below), 0L, 254L));
+    }
+}
+
+void visualize::unpack_log8(const uint8_t *codes, size_t size, double scale, double *data) {
+    // a table lookup per element, so decoding on the render side stays cheap without a vector log/exp
+    auto &levels = log8_levels();
+    for (size_t i = 0; i < size; i++) {
+        data[i] = levels[codes[i]] * scale;
+    }
+}
+
+void visualize::compact_frame::pack(const double *data, size_t size) {
+    double largest = 0;
+    for (size_t i = 0; i < size; i++) {
+        largest = std::max(largest, data[i]);
+    }
+    scale = float(largest);
+    // codes are relative to the stored, rounded scale so the receiver decodes with exactly the same one
+    switch (format) {
+    case compact_format::log8:
+        log.resize(size);
+        pack_log8(data, size, scale, log.data());
+        break;
+    default:
+        linear.resize(size);
+        pack_linear16(data, size, scale, linear.data());
+        break;
+    }
+}
+
+void visualize::compact_frame::unpack(double *data) const {
+    switch (format) {
+    case compact_format::log8:
+        unpack_log8(log.data(), log.size(), scale, data);
+        break;
+    default:
+        unpack_linear16(linear.data(), linear.size(), scale, data);
+        break;
+    }
+}
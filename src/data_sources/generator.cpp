@@ -0,0 +1,98 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "data_sources/generator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+visualize::generator_source::generator_source(size_t buffer_len, settings config) :
+    data_source(buffer_len),
+    buffer_len(buffer_len),
+    config(std::move(config)),
+    rng(this->config.seed),
+    tone_phases(this->config.tones.size()) {}
+
+double visualize::generator_source::next_sample() {
+    auto &c = config;
+    auto step = [&c](double frequency) { return 2 * M_PI * frequency / c.sample_rate; };
+    double value = 0;
+    switch (c.kind) {
+    case signal::silence: break;
+    case signal::sine:
+        value = sin(phase);
+        phase = fmod(phase + step(c.frequency), 2 * M_PI);
+        break;
+    case signal::sweep: {
+        // a sweep shorter than a sample stays at the start frequency
+        auto period = std::max<size_t>(size_t(c.sweep_duration * c.sample_rate), 1);
+        auto t = double(produced % period) / double(period);
+        value = sin(phase);
+        phase = fmod(phase + step(c.frequency * pow(c.frequency_end / c.frequency, t)), 2 * M_PI);
+        break;
+    }
+    case signal::multitone:
+        for (size_t i = 0; i < c.tones.size(); i++) {
+            value += sin(tone_phases[i]) / double(c.tones.size());
+            tone_phases[i] = fmod(tone_phases[i] + step(c.tones[i]), 2 * M_PI);
+        }
+        break;
+    case signal::white_noise: value = uniform(rng); break;
+    case signal::pink_noise: {
+        // Paul Kellet's refined pink noise filter, scaled back to roughly [-1, 1]
+        auto white = uniform(rng);
+        pink[0] = 0.99886 * pink[0] + white * 0.0555179;
+        pink[1] = 0.99332 * pink[1] + white * 0.0750759;
+        pink[2] = 0.96900 * pink[2] + white * 0.1538520;
+        pink[3] = 0.86650 * pink[3] + white * 0.3104856;
+        pink[4] = 0.55000 * pink[4] + white * 0.5329522;
+        pink[5] = -0.7616 * pink[5] - white * 0.0168980;
+        value = (pink[0] + pink[1] + pink[2] + pink[3] + pink[4] + pink[5] + pink[6] + white * 0.5362) * 0.11;
+        pink[6] = white * 0.115926;
+        break;
+    }
+    case signal::impulse: {
+        auto interval = std::max<size_t>(size_t(c.impulse_interval * c.sample_rate), 1);
+        value = produced % interval == 0 ? 1.0 : 0.0;
+        break;
+    }
+    }
+    produced++;
+    return value * c.amplitude;
+}
+
+bool visualize::generator_source::do_grab_audio(double *output) {
+    if (config.length != 0 && produced + buffer_len > config.length) {
+        return false;
+    }
+    if (config.paced) {
+        using namespace std::chrono;
+        auto now = steady_clock::now();
+        if (produced == 0) {
+            start = now;
+        }
+        auto block = duration<double>(double(buffer_len) / config.sample_rate);
+        auto due = start + duration_cast<steady_clock::duration>(block * (double(produced) / double(buffer_len) + 1));
+        if (now > due + block) {
+            late++;
+        }
+        std::this_thread::sleep_until(due);
+    }
+    for (size_t i = 0; i < buffer_len; i++) {
+        output[i] = next_sample();
+    }
+    return true;
+}
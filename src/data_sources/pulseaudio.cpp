@@ -16,18 +16,20 @@
  */
 #include "data_sources/pulseaudio.hpp"
 #include <iostream>
+#include <limits>
 #include <pulse/error.h>
 
 namespace {
     const pa_sample_spec spec { PA_SAMPLE_S16NE, 44100, 2 };
 }
 
-visualize::pulseaudio_source::pulseaudio_source(size_t buffer_len) :
+visualize::pulseaudio_source::pulseaudio_source(size_t buffer_len, const char *device, pa_usec_t latency_budget) :
     data_source(buffer_len),
     buffer_len(buffer_len),
+    latency_budget(latency_budget),
     pulse_buffer(std::make_unique<int16_t[]>(buffer_len * 2)) {
     int err;
-    simple = pa_simple_new(nullptr, "visualizer", PA_STREAM_RECORD, nullptr, "record", &spec, nullptr, nullptr, &err);
+    simple = pa_simple_new(nullptr, "visualizer", PA_STREAM_RECORD, device, "record", &spec, nullptr, nullptr, &err);
     if (!bool(simple)) {
         std::cerr << "Pulse connection error: " << pa_strerror(err) << std::endl;
     } else {
@@ -46,6 +48,13 @@ bool visualize::pulseaudio_source::do_grab_audio(double *output) {
         return false;
     }
     int err;
+    if (latency_budget != 0) {
+        // a stalled reader leaves audio piling up in the server, drop it instead of falling further behind
+        auto latency = pa_simple_get_latency(simple, &err);
+        if (latency != pa_usec_t(-1) && latency > latency_budget && pa_simple_flush(simple, &err) >= 0) {
+            skipped++;
+        }
+    }
     if (pa_simple_read(simple, pulse_buffer.get(), buffer_len * 2, &err) < 0) {
         std::cerr << "Pulse read error: " << err << std::endl;
     }
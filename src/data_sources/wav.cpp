@@ -0,0 +1,151 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "data_sources/wav.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    constexpr uint16_t format_pcm = 1;
+    constexpr uint16_t format_float = 3;
+    constexpr uint16_t format_extensible = 0xfffe;
+
+    template<typename T>
+    T read_le(const char *data) {
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            value |= T(T(uint8_t(data[i])) << (8 * i));
+        }
+        return value;
+    }
+} // namespace
+
+visualize::wav_source::wav_source(const std::string &path, size_t buffer_len, size_t hop) :
+    data_source(buffer_len),
+    buffer_len(buffer_len),
+    hop(hop == 0 ? buffer_len : hop),
+    file(path, std::ios::binary),
+    path(path),
+    window(buffer_len) {
+    if (!file) {
+        std::cerr << "WAV error: could not open " << path << std::endl;
+        return;
+    }
+    valid = parse_header();
+}
+
+bool visualize::wav_source::parse_header() {
+    char header[12];
+    if (!file.read(header, sizeof(header)) || memcmp(header, "RIFF", 4) != 0 || memcmp(&header[8], "WAVE", 4) != 0) {
+        std::cerr << "WAV error: " << path << " is not a RIFF WAVE file" << std::endl;
+        return false;
+    }
+
+    bool have_format = false;
+    char chunk[8];
+    while (file.read(chunk, sizeof(chunk))) {
+        auto size = read_le<uint32_t>(&chunk[4]);
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            std::vector<char> fmt(size + (size & 1));
+            if (!file.read(fmt.data(), std::streamsize(fmt.size()))) {
+                break;
+            }
+            format = read_le<uint16_t>(&fmt[0]);
+            channels = read_le<uint16_t>(&fmt[2]);
+            rate = read_le<uint32_t>(&fmt[4]);
+            block_align = read_le<uint16_t>(&fmt[12]);
+            bits = read_le<uint16_t>(&fmt[14]);
+            if (format == format_extensible && size >= 26) {
+                // the first two bytes of the sub-format GUID carry the actual format tag
+                format = read_le<uint16_t>(&fmt[24]);
+            }
+            have_format = true;
+        } else if (memcmp(chunk, "data", 4) == 0 && have_format) {
+            data_left = size;
+            break;
+        } else {
+            file.seekg(size + (size & 1), std::ios::cur);
+        }
+    }
+
+    bool supported = (format == format_pcm && (bits == 8 || bits == 16 || bits == 24 || bits == 32))
+                     || (format == format_float && bits == 32);
+    if (!have_format || data_left == 0) {
+        std::cerr << "WAV error: " << path << " has no audio data" << std::endl;
+        return false;
+    }
+    if (!supported || channels == 0 || block_align != channels * bits / 8) {
+        std::cerr << "WAV error: " << path << " uses an unsupported sample format" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+double visualize::wav_source::decode(const char *sample) const {
+    if (format == format_float) {
+        float value;
+        memcpy(&value, sample, sizeof(value));
+        return value;
+    }
+    switch (bits) {
+    case 8: return (double(uint8_t(sample[0])) - 128) / 128;
+    case 16: return double(int16_t(read_le<uint16_t>(sample))) / 32768;
+    case 24: {
+        // assemble in the top of an int32 to sign-extend
+        auto value = int32_t(uint32_t(uint8_t(sample[0])) << 8 | uint32_t(uint8_t(sample[1])) << 16
+                             | uint32_t(uint8_t(sample[2])) << 24)
+                     >> 8;
+        return double(value) / 8388608;
+    }
+    default: return double(int32_t(read_le<uint32_t>(sample))) / 2147483648.0;
+    }
+}
+
+bool visualize::wav_source::do_grab_audio(double *output) {
+    if (!valid) {
+        return false;
+    }
+    // the first grab fills the whole window, later ones only advance it by the hop
+    size_t frames = primed ? hop : buffer_len;
+    size_t bytes = frames * block_align;
+    if (bytes > data_left) {
+        return false;
+    }
+    raw.resize(bytes);
+    if (!file.read(raw.data(), std::streamsize(bytes))) {
+        std::cerr << "WAV error: " << path << " ended early" << std::endl;
+        valid = false;
+        return false;
+    }
+    data_left -= bytes;
+    frames_read += frames;
+
+    // with hops larger than the window only the newest frames end up in it
+    size_t kept = std::min(frames, buffer_len);
+    std::move(window.begin() + std::ptrdiff_t(kept), window.end(), window.begin());
+    size_t sample_size = bits / 8;
+    for (size_t f = frames - kept; f < frames; f++) {
+        double mixed = 0;
+        for (size_t c = 0; c < channels; c++) {
+            mixed += decode(&raw[f * block_align + c * sample_size]);
+        }
+        window[buffer_len - frames + f] = mixed / channels;
+    }
+    primed = true;
+    std::copy(window.begin(), window.end(), output);
+    return true;
+}
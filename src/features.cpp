@@ -0,0 +1,107 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "features.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    //! onsets closer than this are treated as one
+    constexpr double min_onset_gap = 0.1;
+    //! tempo estimates are folded into [min_bpm, 2 * min_bpm)
+    constexpr double min_bpm = 80;
+} // namespace
+
+visualize::feature_tracker::feature_tracker(size_t bins) :
+    bins(bins),
+    last(std::make_unique<double[]>(bins)),
+    band_of(std::make_unique<uint8_t[]>(bins)) {
+    // band k covers bins [bins^(k/n), bins^((k+1)/n)), dc joins the lowest band
+    for (size_t i = 1; i < bins; i++) {
+        auto band = size_t(log(double(i)) / log(double(bins)) * spectral_features::band_count);
+        band_of[i] = uint8_t(std::min(band, spectral_features::band_count - 1));
+    }
+}
+
+const visualize::spectral_features &visualize::feature_tracker::finish(double time) {
+    current.flux = frame.flux / double(bins);
+    current.centroid = frame.total > 0 ? frame.weighted / frame.total / double(bins) : 0;
+    current.band_energy = frame.energy;
+
+    // adaptive threshold: an onset stands out from the flux of the preceding frames
+    double mean = 0, variance = 0;
+    for (size_t i = 0; i < history_count; i++) {
+        mean += history[i] / double(history_count);
+    }
+    for (size_t i = 0; i < history_count; i++) {
+        variance += (history[i] - mean) * (history[i] - mean) / double(history_count);
+    }
+    auto last_onset = onsets[(onset_pos + onset_len - 1) % onset_len];
+    current.onset = history_count >= history_len / 2 && current.flux > mean + 1.5 * sqrt(variance)
+                    && (onset_count == 0 || time - last_onset >= min_onset_gap);
+
+    history[history_pos] = current.flux;
+    history_pos = (history_pos + 1) % history_len;
+    history_count = std::min(history_count + 1, history_len);
+
+    if (current.onset) {
+        onsets[onset_pos] = time;
+        onset_pos = (onset_pos + 1) % onset_len;
+        onset_count = std::min(onset_count + 1, onset_len);
+        estimate_tempo();
+    }
+    return current;
+}
+
+void visualize::feature_tracker::estimate_tempo() {
+    if (onset_count < 4) {
+        return;
+    }
+    // every inter-onset interval votes for its tempo, folded into one octave so that skipped or doubled beats agree
+    std::array<double, size_t(min_bpm)> votes {};
+    std::array<double, onset_len> folded {};
+    size_t first = (onset_pos + onset_len - onset_count) % onset_len;
+    for (size_t i = 1; i < onset_count; i++) {
+        auto interval = onsets[(first + i) % onset_len] - onsets[(first + i - 1) % onset_len];
+        if (interval <= 0) {
+            continue;
+        }
+        auto bpm = 60 / interval;
+        while (bpm < min_bpm) {
+            bpm *= 2;
+        }
+        while (bpm >= 2 * min_bpm) {
+            bpm /= 2;
+        }
+        folded[i] = bpm;
+        auto bin = size_t(bpm - min_bpm);
+        votes[bin] += 1;
+        votes[(bin + 1) % votes.size()] += 0.5;
+        votes[(bin + votes.size() - 1) % votes.size()] += 0.5;
+    }
+    auto peak = min_bpm + double(std::max_element(votes.begin(), votes.end()) - votes.begin());
+
+    // refine the 1 bpm wide winner with the intervals that voted for it
+    double sum = 0;
+    size_t count = 0;
+    for (size_t i = 1; i < onset_count; i++) {
+        if (folded[i] != 0 && std::abs(folded[i] - peak) <= 1.5) {
+            sum += folded[i];
+            count++;
+        }
+    }
+    current.bpm = count > 0 ? sum / double(count) : peak;
+}
@@ -19,3 +19,25 @@
 void visualize::filter::apply(double *output) {
     do_apply(output);
 }
+
+double visualize::filter::apply_range(double *output, size_t begin, size_t end) {
+    return do_apply_range(output, begin, end);
+}
+
+void visualize::filter::reduce(double total) {
+    do_reduce(total);
+}
+
+bool visualize::filter::partitionable() const {
+    return do_partitionable();
+}
+
+double visualize::filter::do_apply_range(double *, size_t, size_t) {
+    return 0;
+}
+
+void visualize::filter::do_reduce(double) {}
+
+bool visualize::filter::do_partitionable() const {
+    return false;
+}
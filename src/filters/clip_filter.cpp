@@ -20,7 +20,12 @@
 visualize::clip_filter::clip_filter(size_t size) : buffer_size(size) {}
 
 void visualize::clip_filter::do_apply(double *data) {
-    for (size_t i = 0; i < buffer_size; i++) {
+    do_apply_range(data, 0, buffer_size);
+}
+
+double visualize::clip_filter::do_apply_range(double *data, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
         data[i] = std::min(data[i], 1.0);
     }
+    return 0;
 }
@@ -22,7 +22,11 @@ visualize::peek_filter::peek_filter(size_t data_size, double gravity) :
     gravity(gravity / 1000) {}
 
 void visualize::peek_filter::do_apply(double *data) {
-    for (size_t i = 0; i < data_size; i++) {
+    do_apply_range(data, 0, data_size);
+}
+
+double visualize::peek_filter::do_apply_range(double *data, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
         auto &peek = peeks[i];
         auto &curr = data[i];
         peek = std::max(curr, peek);
@@ -34,4 +38,5 @@ void visualize::peek_filter::do_apply(double *data) {
             peek = 0;
         }
     }
+    return 0;
 }
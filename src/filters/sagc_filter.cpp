@@ -20,13 +20,20 @@
 visualize::sagc_filter::sagc_filter(size_t data_size) : data_size(data_size) {}
 
 void visualize::sagc_filter::do_apply(double *data) {
+    do_reduce(do_apply_range(data, 0, data_size));
+}
+
+double visualize::sagc_filter::do_apply_range(double *data, size_t begin, size_t end) {
     double rms = 0;
-    for (size_t i = 0; i < data_size; i++) {
+    for (size_t i = begin; i < end; i++) {
         auto &current = data[i];
         current *= gain;
         rms += current * current / data_size;
     }
+    return rms;
+}
 
+void visualize::sagc_filter::do_reduce(double rms) {
 #define sq(n) n *n
     if (rms > sq(0.5)) {
         gain *= 0.85;
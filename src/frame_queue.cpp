@@ -0,0 +1,213 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "frame_queue.hpp"
+#include <algorithm>
+
+visualize::frame_queue::frame_queue(size_t capacity, size_t frame_size, overflow_policy policy,
+                                    compact_format format) :
+    frame_size(frame_size),
+    policy(policy),
+    format(format),
+    slots(std::max<size_t>(capacity, 1)),
+    incoming(format),
+    outgoing(format),
+    scratch(frame_size),
+    merged(slots.size()) {
+    if (format == compact_format::none) {
+        for (auto &slot : slots) {
+            slot.data.resize(frame_size);
+        }
+        return;
+    }
+    // packing a silent frame sizes the codes, so neither side allocates later on
+    packed.resize(slots.size(), compact_frame(format));
+    for (auto *payload : { &incoming, &outgoing }) {
+        payload->pack(scratch.data(), frame_size);
+    }
+    for (auto &payload : packed) {
+        payload.pack(scratch.data(), frame_size);
+    }
+}
+
+void visualize::frame_queue::merge(const double *data, size_t frames) {
+    // the frame taken out of the newest slot is in incoming or scratch, see push
+    if (format != compact_format::none) {
+        incoming.unpack(scratch.data());
+    }
+    auto *target = scratch.data();
+    if (policy == overflow_policy::coalesce_max) {
+        for (size_t i = 0; i < frame_size; i++) {
+            target[i] = std::max(target[i], data[i]);
+        }
+    } else {
+        auto n = double(frames);
+        for (size_t i = 0; i < frame_size; i++) {
+            target[i] += (data[i] - target[i]) / n;
+        }
+    }
+    if (format != compact_format::none) {
+        incoming.pack(scratch.data(), frame_size);
+    }
+}
+
+bool visualize::frame_queue::push(const double *data, uint64_t sequence,
+                                  std::chrono::steady_clock::time_point captured, const spectral_features &features) {
+    auto compact = format != compact_format::none;
+    if (compact) {
+        // only the producer touches incoming, so quantizing doesn't hold up the consumer
+        incoming.pack(data, frame_size);
+    }
+    auto payload = compact ? incoming.bytes() : frame_size * sizeof(double);
+    std::unique_lock guard(lock);
+    if (closed) {
+        return false;
+    }
+    if (count == slots.size()) {
+        switch (policy) {
+        case overflow_policy::block:
+            counts.blocked++;
+            not_full.wait(guard, [this]() { return count < slots.size() || closed; });
+            if (closed) {
+                return false;
+            }
+            break;
+        case overflow_policy::drop_oldest:
+        case overflow_policy::catch_up:
+            head = (head + 1) % slots.size();
+            count--;
+            counts.dropped++;
+            break;
+        case overflow_policy::coalesce_max:
+        case overflow_policy::coalesce_mean: {
+            // the newest frame is taken out of its slot and merged without the lock, the consumer leaves the slot
+            // alone until it's put back
+            auto index = (head + count - 1) % slots.size();
+            if (compact) {
+                std::swap(packed[index], incoming);
+            } else {
+                std::swap(slots[index].data, scratch);
+            }
+            auto frames = ++merged[index];
+            merging = true;
+            guard.unlock();
+            merge(data, frames);
+            guard.lock();
+            if (compact) {
+                std::swap(packed[index], incoming);
+            } else {
+                std::swap(slots[index].data, scratch);
+            }
+            merging = false;
+            auto &newest = slots[index];
+            newest.sequence = sequence;
+            newest.captured = captured;
+            auto onset = newest.features.onset;
+            newest.features = features;
+            newest.features.onset = newest.features.onset || onset;
+            counts.pushed++;
+            counts.coalesced++;
+            counts.bytes += payload;
+            guard.unlock();
+            not_empty.notify_one();
+            return true;
+        }
+        }
+    }
+    auto index = (head + count) % slots.size();
+    auto &slot = slots[index];
+    if (compact) {
+        std::swap(packed[index], incoming);
+    } else {
+        std::copy_n(data, frame_size, slot.data.begin());
+    }
+    slot.sequence = sequence;
+    slot.captured = captured;
+    slot.features = features;
+    merged[index] = 1;
+    count++;
+    counts.pushed++;
+    counts.bytes += payload;
+    guard.unlock();
+    not_empty.notify_one();
+    return true;
+}
+
+void visualize::frame_queue::take(frame &out) {
+    if (policy == overflow_policy::catch_up && count > 1) {
+        counts.skipped += count - 1;
+        head = (head + count - 1) % slots.size();
+        count = 1;
+    }
+    auto &slot = slots[head];
+    out.data.resize(frame_size);
+    if (format != compact_format::none) {
+        // decoded by the caller once the lock is released
+        std::swap(packed[head], outgoing);
+    } else {
+        std::copy(slot.data.begin(), slot.data.end(), out.data.begin());
+    }
+    out.sequence = slot.sequence;
+    out.captured = slot.captured;
+    out.features = slot.features;
+    head = (head + 1) % slots.size();
+    count--;
+    counts.popped++;
+}
+
+bool visualize::frame_queue::pop(frame &out) {
+    std::unique_lock guard(lock);
+    // a frame being coalesced into is put back before the queue counts as drained
+    not_empty.wait(guard, [this]() { return ready() || (closed && !merging); });
+    if (!ready()) {
+        return false;
+    }
+    take(out);
+    guard.unlock();
+    not_full.notify_one();
+    if (format != compact_format::none) {
+        outgoing.unpack(out.data.data());
+    }
+    return true;
+}
+
+bool visualize::frame_queue::try_pop(frame &out) {
+    std::unique_lock guard(lock);
+    if (!ready()) {
+        return false;
+    }
+    take(out);
+    guard.unlock();
+    not_full.notify_one();
+    if (format != compact_format::none) {
+        outgoing.unpack(out.data.data());
+    }
+    return true;
+}
+
+visualize::frame_queue::counters visualize::frame_queue::stats() {
+    std::lock_guard _(lock);
+    return counts;
+}
+
+void visualize::frame_queue::close() {
+    {
+        std::lock_guard _(lock);
+        closed = true;
+    }
+    not_empty.notify_all();
+    not_full.notify_all();
+}
@@ -0,0 +1,244 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "headless.hpp"
+#include "data_sources/wav.hpp"
+#include "filters/clip_filter.hpp"
+#include "filters/peek_filter.hpp"
+#include "filters/sagc_filter.hpp"
+#include "frame_queue.hpp"
+#include "pipeline.hpp"
+#include "postprocessing.hpp"
+#include "rasterizer.hpp"
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using format = visualize::headless_options::format;
+
+    //! writes rasterized frames in one of the \p headless_options::format formats
+    struct encoder {
+        explicit encoder(const visualize::headless_options &options) : options(options) {
+            auto pixels = size_t(options.width) * size_t(options.height);
+            scratch.resize(pixels * 3);
+        }
+
+        bool open() {
+            if (options.output_format == format::ppm) {
+                return true;
+            }
+            if (options.output != "-") {
+                file.open(options.output, std::ios::binary);
+                if (!file) {
+                    std::cerr << "Could not open " << options.output << " for writing" << std::endl;
+                    return false;
+                }
+                out = &file;
+            }
+            if (options.output_format == format::y4m) {
+                *out << "YUV4MPEG2 W" << options.width << " H" << options.height << " F" << options.fps
+                     << ":1 Ip A1:1 C444\n";
+            }
+            return bool(*out);
+        }
+
+        //! \p pixels holds 0xAARRGGBB values with a pitch of \p options.width
+        bool write(const uint32_t *pixels, int number) {
+            auto count = size_t(options.width) * size_t(options.height);
+            switch (options.output_format) {
+            case format::rgb: to_rgb(pixels, count); return emit(*out, count * 3);
+            case format::y4m:
+                to_yuv444(pixels, count);
+                *out << "FRAME\n";
+                return emit(*out, count * 3);
+            case format::ppm: {
+                to_rgb(pixels, count);
+                // the pattern was checked by render_headless
+                visualize::expand_frame_pattern(options.output, number, name);
+                std::ofstream image(name, std::ios::binary);
+                image << "P6\n" << options.width << ' ' << options.height << "\n255\n";
+                if (!emit(image, count * 3)) {
+                    std::cerr << "Could not write " << name << std::endl;
+                    return false;
+                }
+                return true;
+            }
+            }
+            return false;
+        }
+
+    private:
+        bool emit(std::ostream &stream, size_t bytes) {
+            stream.write(reinterpret_cast<const char *>(scratch.data()), std::streamsize(bytes));
+            return bool(stream);
+        }
+
+        void to_rgb(const uint32_t *pixels, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                scratch[i * 3] = uint8_t(pixels[i] >> 16);
+                scratch[i * 3 + 1] = uint8_t(pixels[i] >> 8);
+                scratch[i * 3 + 2] = uint8_t(pixels[i]);
+            }
+        }
+
+        //! BT.601 limited range, written as three planes
+        void to_yuv444(const uint32_t *pixels, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                int r = uint8_t(pixels[i] >> 16), g = uint8_t(pixels[i] >> 8), b = uint8_t(pixels[i]);
+                scratch[i] = uint8_t(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+                scratch[count + i] = uint8_t(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+                scratch[count * 2 + i] = uint8_t(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+            }
+        }
+
+        const visualize::headless_options &options;
+        std::ofstream file;
+        std::ostream *out = &std::cout;
+        std::vector<uint8_t> scratch;
+        std::string name;
+    };
+
+    //! lays bars out like the window does for a single panel
+    void layout(std::vector<visualize::rasterizer::rect> &rects, const double *bars, int width, int height) {
+        auto count = int(rects.size());
+        int w = width / count;
+        int cpos = width % count / 2;
+        for (int i = 0; i < count; i++) {
+            int h = static_cast<int>(bars[i] * height);
+            rects[size_t(i)] = { cpos, height - h, w, h };
+            cpos += w;
+        }
+    }
+} // namespace
+
+bool visualize::expand_frame_pattern(const std::string &pattern, int number, std::string &name) {
+    name.clear();
+    bool expanded = false;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        if (pattern[i] != '%') {
+            name += pattern[i];
+            continue;
+        }
+        if (i + 1 < pattern.size() && pattern[i + 1] == '%') {
+            name += '%';
+            i++;
+            continue;
+        }
+        auto j = i + 1;
+        auto fill = j < pattern.size() && pattern[j] == '0' ? '0' : ' ';
+        size_t width = 0;
+        for (; j < pattern.size() && pattern[j] >= '0' && pattern[j] <= '9'; j++) {
+            width = width * 10 + size_t(pattern[j] - '0');
+            if (width > 64) {
+                return false;
+            }
+        }
+        if (expanded || j == pattern.size() || pattern[j] != 'd') {
+            return false;
+        }
+        auto digits = std::to_string(number);
+        if (digits.size() < width) {
+            name.append(width - digits.size(), fill);
+        }
+        name += digits;
+        expanded = true;
+        i = j;
+    }
+    return expanded;
+}
+
+int visualize::render_headless(const headless_options &options) {
+    std::string name;
+    if (options.output_format == format::ppm && !expand_frame_pattern(options.output, 0, name)) {
+        std::cerr << "The output pattern needs exactly one %d and no other % but %%, e.g. frame%06d.ppm" << std::endl;
+        return 2;
+    }
+    auto src = std::make_unique<wav_source>(options.input, options.resolution * 2);
+    if (!src->good()) {
+        return 1;
+    }
+    auto &wav = *src;
+    uint64_t rate = wav.sample_rate(), fps = uint64_t(std::max(options.fps, 1));
+
+    std::vector<std::unique_ptr<filter>> filters;
+    filters.emplace_back(new sagc_filter(options.resolution));
+    filters.emplace_back(new clip_filter(options.resolution));
+    filters.emplace_back(new peek_filter(options.resolution, options.gravity));
+    pipeline pipe(options.resolution, std::move(src), std::move(filters));
+    pipe.set_frame_rate(double(fps));
+
+    encoder out(options);
+    if (!out.open()) {
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    frame_queue queue(options.queue_frames, options.barcount);
+    std::thread analysis([&]() {
+        auto bars = std::make_unique<double[]>(options.barcount);
+        for (uint64_t n = 0;; n++) {
+            // frame n starts at sample n * rate / fps, so hops follow rates that don't divide the sample rate exactly
+            if (n > 0) {
+                wav.set_hop(size_t(n * rate / fps - (n - 1) * rate / fps));
+            }
+            if (!pipe.step()) {
+                break;
+            }
+            uint64_t sequence;
+            std::chrono::steady_clock::time_point captured;
+            {
+                auto [data, _] = pipe.output.acquire();
+                calculate_bars(bars.get(), options.barcount, data, pipe.output.data_size);
+                sequence = pipe.output.sequence;
+                captured = pipe.output.captured;
+            }
+            if (!queue.push(bars.get(), sequence, captured)) {
+                break;
+            }
+        }
+        queue.close();
+    });
+
+    auto pixels = std::make_unique<uint32_t[]>(size_t(options.width) * size_t(options.height));
+    rasterizer raster(0xff000000 | options.foreground, 0xff000000 | options.background);
+    raster.target(pixels.get(), size_t(options.width), options.width, options.height);
+    std::vector<rasterizer::rect> rects(options.barcount), dirty;
+
+    frame current;
+    int rendered = 0;
+    bool ok = true;
+    while (queue.pop(current)) {
+        layout(rects, current.data.data(), options.width, options.height);
+        raster.draw(rects.data(), rects.size(), dirty);
+        if (!out.write(pixels.get(), rendered)) {
+            ok = false;
+            queue.close();
+            break;
+        }
+        rendered++;
+    }
+    analysis.join();
+
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+    auto seconds = double(rendered) / double(fps);
+    std::cerr << "Rendered " << rendered << " frames (" << seconds << " s of video) in " << wall.count() << " s, "
+              << seconds / wall.count() << "x real time" << std::endl;
+    return ok ? 0 : 1;
+}
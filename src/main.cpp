@@ -15,133 +15,542 @@
  * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include "frame_queue.hpp"
+#include "headless.hpp"
+#include "panel.hpp"
+#include "pipeline.hpp"
 #include "postprocessing.hpp"
+#include "rasterizer.hpp"
+#include "realtime.hpp"
+#include "settings.hpp"
+#include "worker_pool.hpp"
 #include <SDL.h>
+#include <array>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cmath>
 #include <data_sources/pulseaudio.hpp>
-#include <fftw3.h>
 #include <filter.hpp>
 #include <filters/clip_filter.hpp>
 #include <filters/peek_filter.hpp>
 #include <filters/sagc_filter.hpp>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
 
 namespace visualize {
-    struct color {
-        uint8_t r, g, b;
-    };
+    //! which source to gather data from (see \p data_sources)
+    using source = pulseaudio_source;
 
-    //! configuration interface
-    static constexpr struct config {
-        /** \brief speed of peek reduction
-         * gravity is defined to be 1000 * peek_reduction_per_sample
-         */
-        double gravity = 100.0 / 6.0;
-
-        /** \brief number of bars to display on screen
-         *
-         * best results are achieved by using fullscreen and having
-         * \code
-         *  screen_width = n * barcount
-         * \endcode
-         * where n is a positive integer
-         */
-        int barcount = 160;
-        /** \brief size of fftw output
-         *
-         * the amount of samples taken for each fftw input is twice the amount of output
-         */
-        size_t resolution = 2048;
-        //! window backgrond color
-        color background = { 0, 0, 0 };
-        //! bar foregrond color
-        color foreground = { 255, 255, 255 };
-
-        //! which source to gather data from (see \p data_sources)
-        using source = pulseaudio_source;
-
-        //! SDL_Window flags
-        Uint32 window_flags = SDL_WINDOW_RESIZABLE;
-        // for example SDL_WINDOW_RESIZABLE | SDL_WINDOW_FULLSCREEN to start fullscreen
-        //! SDL_Renderer flags
-        Uint32 renderer_flags = SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED;
-    } config;
-
-    void audio_thread(std::atomic_bool &run, buffer &buffer, std::unique_ptr<data_source> src,
-                      std::vector<std::unique_ptr<filter>> &filters) {
-        auto fftw_in = std::make_unique<double[]>(buffer.data_size * 2);
-        auto fftw_out = std::make_unique<fftw_complex[]>(buffer.data_size + 1);
-        auto plan = fftw_plan_dft_r2c_1d(int(buffer.data_size * 2), fftw_in.get(), fftw_out.get(), FFTW_MEASURE);
-
-        while (run.load(std::memory_order_relaxed)) {
-            if (!src->grab_audio(fftw_in.get())) {
-                run.store(false, std::memory_order_relaxed);
-                break;
+    std::vector<std::unique_ptr<filter>> make_filters(const settings &config) {
+        std::vector<std::unique_ptr<filter>> filters;
+        filters.emplace_back(new sagc_filter(config.resolution));
+        filters.emplace_back(new clip_filter(config.resolution));
+        filters.emplace_back(new peek_filter(config.resolution, config.gravity));
+        return filters;
+    }
+
+    std::shared_ptr<panel> make_panel(const settings &config, const std::string &device, worker_pool &pool) {
+        auto result = std::make_shared<panel>();
+        result->device = device;
+        parallel_options parallel;
+        if (config.parallel) {
+            parallel.pool = &pool;
+            parallel.fft_threads = config.fft_threads;
+            parallel.chunk_bins = config.chunk_bins;
+        }
+        auto src = std::make_unique<source>(config.resolution * 2, device.empty() ? nullptr : device.c_str(),
+                                            config.latency_budget);
+        result->src = src.get();
+        result->pipe = std::make_unique<pipeline>(config.resolution, std::move(src), make_filters(config), parallel);
+        result->queue = std::make_unique<frame_queue>(config.handoff_frames, config.resolution, config.handoff_policy,
+                                                      config.handoff_format);
+        result->pipe->set_output_queue(result->queue.get());
+        return result;
+    }
+
+    //! presents bars through the window surface, see \p settings::software_rendering
+    struct surface_presenter {
+        explicit surface_presenter(SDL_Window *window) :
+            window(window),
+            raster(0, 0) {}
+        ~surface_presenter() {
+            if (bool(offscreen)) {
+                SDL_FreeSurface(offscreen);
+            }
+        }
+        surface_presenter(const surface_presenter &) = delete;
+        surface_presenter &operator=(const surface_presenter &) = delete;
+
+        //! (re)acquires the window surface, has to be called after every resize and change of layout or colors
+        bool reset(color foreground, color background) {
+            surface = SDL_GetWindowSurface(window);
+            if (!bool(surface)) {
+                std::cerr << SDL_GetError() << std::endl;
+                return false;
+            }
+            if (bool(offscreen)) {
+                SDL_FreeSurface(offscreen);
+                offscreen = nullptr;
+            }
+            // anything that isn't 32 bit gets drawn into an ARGB surface first and converted while blitting
+            auto target = surface;
+            if (surface->format->BytesPerPixel != 4) {
+                offscreen = SDL_CreateRGBSurfaceWithFormat(0, surface->w, surface->h, 32, SDL_PIXELFORMAT_ARGB8888);
+                if (!bool(offscreen)) {
+                    std::cerr << SDL_GetError() << std::endl;
+                    return false;
+                }
+                target = offscreen;
+            }
+            raster = rasterizer(SDL_MapRGB(target->format, foreground.r, foreground.g, foreground.b),
+                                SDL_MapRGB(target->format, background.r, background.g, background.b));
+            return invalidate();
+        }
+
+        //! redraws and presents the whole window with the next frame, e.g. after it was uncovered or restored
+        bool invalidate() {
+            auto target = bool(offscreen) ? offscreen : surface;
+            full_update = true;
+            return draw_locked(target, [this, target]() {
+                raster.target(static_cast<uint32_t *>(target->pixels), size_t(target->pitch) / 4, target->w,
+                              target->h);
+            });
+        }
+
+        bool present(const SDL_Rect *rects, size_t count) {
+            bars.resize(count);
+            std::transform(rects, &rects[count], bars.begin(),
+                           [](auto &r) { return rasterizer::rect { r.x, r.y, r.w, r.h }; });
+            auto target = bool(offscreen) ? offscreen : surface;
+            if (!draw_locked(target, [this]() { raster.draw(bars.data(), bars.size(), dirty); })) {
+                return false;
             }
-            fftw_execute(plan);
-            {
-                auto [data, _] = buffer.acquire();
-                for (size_t i = 0; i < buffer.data_size; i++) {
-                    data[i] = hypot(fftw_out[i][0], fftw_out[i][1]);
+
+            updates.resize(dirty.size());
+            std::transform(dirty.begin(), dirty.end(), updates.begin(),
+                           [](auto &r) { return SDL_Rect { r.x, r.y, r.w, r.h }; });
+            if (bool(offscreen) && full_update) {
+                if (SDL_BlitSurface(offscreen, nullptr, surface, nullptr) < 0) {
+                    std::cerr << SDL_GetError() << std::endl;
+                    return false;
                 }
-                for (auto &filter : filters) {
-                    filter->apply(data);
+            } else if (bool(offscreen)) {
+                for (auto area : updates) {
+                    auto from = area;
+                    if (SDL_BlitSurface(offscreen, &from, surface, &area) < 0) {
+                        std::cerr << SDL_GetError() << std::endl;
+                        return false;
+                    }
                 }
             }
+            int err = 0;
+            if (full_update) {
+                err = SDL_UpdateWindowSurface(window);
+                full_update = false;
+            } else if (!updates.empty()) {
+                err = SDL_UpdateWindowSurfaceRects(window, updates.data(), int(updates.size()));
+            }
+            if (err < 0) {
+                std::cerr << SDL_GetError() << std::endl;
+                return false;
+            }
+            return true;
         }
-        fftw_destroy_plan(plan);
-    } // namespace visualize
 
-    //! sets up the bars after screen resizes
-    void rescale_rects(std::unique_ptr<SDL_Rect[]> &rects, int width) {
-        auto barcount = int(visualize::config.barcount);
-        int w = width / barcount;
-        int cpos = width % barcount / 2;
-        std::for_each(&rects[0], &rects[size_t(barcount)], [w, &cpos](auto &r) {
-            r.w = w;
-            r.x = cpos;
-            r.y = 1;
-            r.h = 10;
-            cpos += w;
-        });
+    private:
+        template<typename F>
+        bool draw_locked(SDL_Surface *target, F &&draw) {
+            if (SDL_MUSTLOCK(target) && SDL_LockSurface(target) < 0) {
+                std::cerr << SDL_GetError() << std::endl;
+                return false;
+            }
+            draw();
+            if (SDL_MUSTLOCK(target)) {
+                SDL_UnlockSurface(target);
+            }
+            return true;
+        }
+
+        SDL_Window *window;
+        SDL_Surface *surface = nullptr;
+        SDL_Surface *offscreen = nullptr;
+        rasterizer raster;
+        bool full_update = true;
+        std::vector<rasterizer::rect> bars, dirty;
+        std::vector<SDL_Rect> updates;
+    };
+
+    //! the command line, see \p parse_args
+    struct arguments {
+        std::string config_path;
+        //! settings given on the command line, they take precedence over the file on every reload
+        std::vector<std::pair<std::string, std::string>> overrides;
+        bool headless = false;
+        //! everything but the output settings is taken from the configuration later on
+        headless_options options;
+    };
+
+    /** \brief Parses the command line
+     *
+     * \code
+     *  [--config <file>] [--<setting> <value>]...
+     *  [--dump <rgb|y4m|ppm> --input <file.wav> [--output <path or pattern>] [--size <w>x<h>] [--fps <n>]]
+     * \endcode
+     * --dump renders headlessly, see \p render_headless
+     */
+    bool parse_args(int argc, char **argv, arguments &args) try {
+        auto &options = args.options;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            std::string arg = argv[i], value = argv[i + 1];
+            if (arg == "--config") {
+                args.config_path = value;
+            } else if (arg == "--dump") {
+                args.headless = true;
+                if (value == "rgb") {
+                    options.output_format = headless_options::format::rgb;
+                } else if (value == "y4m") {
+                    options.output_format = headless_options::format::y4m;
+                } else if (value == "ppm") {
+                    options.output_format = headless_options::format::ppm;
+                    if (options.output == "-") {
+                        options.output = "frame%06d.ppm";
+                    }
+                } else {
+                    return false;
+                }
+            } else if (arg == "--input") {
+                options.input = value;
+            } else if (arg == "--output") {
+                options.output = value;
+            } else if (arg == "--size") {
+                auto x = value.find('x');
+                if (x == std::string::npos) {
+                    return false;
+                }
+                options.width = std::stoi(value.substr(0, x));
+                options.height = std::stoi(value.substr(x + 1));
+            } else if (arg == "--fps") {
+                options.fps = std::stoi(value);
+            } else if (arg.size() > 2 && arg.compare(0, 2, "--") == 0 && settings::known(arg.substr(2))) {
+                args.overrides.emplace_back(arg.substr(2), value);
+            } else {
+                return false;
+            }
+        }
+        if (argc % 2 == 0) {
+            return false;
+        }
+        std::string name;
+        if (options.output_format == headless_options::format::ppm
+            && !expand_frame_pattern(options.output, 0, name)) {
+            std::cerr << "--output needs exactly one %d and no other % but %%, e.g. frame%06d.ppm" << std::endl;
+            return false;
+        }
+        return !args.headless
+               || (!options.input.empty() && options.width > 0 && options.height > 0 && options.fps > 0);
+    } catch (const std::logic_error &) {
+        return false;
     }
-} // namespace visualize
 
-int main() {
-    visualize::buffer buf(visualize::config.resolution);
-    std::atomic_bool run = true;
-    std::thread audio_thread([&buf, &run]() {
-        std::vector<std::unique_ptr<visualize::filter>> filters;
+    //! reads the configuration file, if any, and applies the command line on top of it
+    bool load_settings(const arguments &args, settings &out) {
+        settings next;
+        if (!args.config_path.empty() && !read_settings(args.config_path, next)) {
+            return false;
+        }
+        std::string error;
+        for (auto &[key, value] : args.overrides) {
+            if (!next.set(key, value, error)) {
+                std::cerr << "--" << key << ": " << error << std::endl;
+                return false;
+            }
+        }
+        if (!next.validate(error)) {
+            std::cerr << error << std::endl;
+            return false;
+        }
+        out = std::move(next);
+        return true;
+    }
+
+    //! splits the window into a grid of \p panel_count panels and sets up their bars after screen resizes
+    void rescale_rects(std::unique_ptr<SDL_Rect[]> &rects, std::unique_ptr<SDL_Rect[]> &panels, size_t panel_count,
+                       size_t barcount, int width, int height) {
+        auto columns = int(std::ceil(std::sqrt(double(panel_count))));
+        auto rows = (int(panel_count) + columns - 1) / columns;
+        for (size_t i = 0; i < panel_count; i++) {
+            auto &panel = panels[i];
+            panel.w = width / columns;
+            panel.h = height / rows;
+            panel.x = int(i) % columns * panel.w;
+            panel.y = int(i) / columns * panel.h;
+
+            int w = panel.w / int(barcount);
+            int cpos = panel.x + panel.w % int(barcount) / 2;
+            std::for_each(&rects[i * barcount], &rects[(i + 1) * barcount], [w, &cpos](auto &r) {
+                r.w = w;
+                r.x = cpos;
+                r.y = 1;
+                r.h = 10;
+                cpos += w;
+            });
+        }
+    }
+
+    //! a configuration change prepared by \p watch_settings, applied by the render thread between two frames
+    struct reload {
+        settings next;
+        //! replacements for all panels, empty if the current ones are kept
+        std::vector<std::shared_ptr<panel>> panels;
+        //! new filter chains for the current panels, empty if they are kept as well
+        std::vector<std::vector<std::unique_ptr<filter>>> filters;
+    };
+
+    //! hands one reload at a time from \p watch_settings to the render thread
+    struct reload_slot {
+        std::mutex lock;
+        std::unique_ptr<reload> pending;
+    };
+
+    /** \brief Rebuilds whatever a change of the configuration file affects, until \p run is cleared
+     *
+     * Runs on its own thread so planning transforms and connecting to the sound server never stall capture or
+     * rendering. New panels record from the moment they're built, so replacing the old ones loses no audio.
+     *
+     * \param current The settings in use when the watch starts
+     */
+    void watch_settings(const arguments &args, settings current, worker_pool &pool, reload_slot &slot,
+                        std::atomic_bool &run) {
+        file_watcher watcher(args.config_path);
+        while (watcher.good() && run.load(std::memory_order_relaxed)) {
+            if (!watcher.wait(std::chrono::milliseconds(250))) {
+                continue;
+            }
+            settings next;
+            if (!load_settings(args, next)) {
+                std::cerr << "Keeping the previous configuration" << std::endl;
+                continue;
+            }
+            // the render thread takes a reload within a frame. the next one has to be based on it, or new filter
+            // chains could end up in the panels they were meant to replace
+            while (run.load(std::memory_order_relaxed)) {
+                {
+                    std::lock_guard _(slot.lock);
+                    if (!bool(slot.pending)) {
+                        break;
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+
+            // every capture blocks a worker, so devices beyond the pool would take turns and all fall behind
+            if (next.devices.size() > pool.size() && next.devices.size() > current.devices.size()) {
+                std::cerr << next.devices.size() << " devices need as many workers but there are " << pool.size()
+                          << ", keeping the previous configuration until a restart" << std::endl;
+                continue;
+            }
+            // the pool was sized for it at startup
+            if (next.parallel != current.parallel) {
+                std::cerr << "Changes to parallel take effect after a restart" << std::endl;
+                next.parallel = current.parallel;
+            }
 
-        filters.emplace_back(new visualize::sagc_filter(buf.data_size));
-        filters.emplace_back(new visualize::clip_filter(buf.data_size));
-        filters.emplace_back(new visualize::peek_filter(buf.data_size, visualize::config.gravity));
+            auto prepared = std::make_unique<reload>();
+            if (next.resolution != current.resolution || next.devices != current.devices
+                || next.latency_budget != current.latency_budget || next.handoff_frames != current.handoff_frames
+                || next.handoff_policy != current.handoff_policy || next.handoff_format != current.handoff_format
+                || next.fft_threads != current.fft_threads || next.chunk_bins != current.chunk_bins) {
+                // the transform size and the sources' block size change together, so the whole chain is rebuilt
+                for (auto &device : next.devices) {
+                    prepared->panels.push_back(make_panel(next, device, pool));
+                }
+                auto failed = std::find_if(prepared->panels.begin(), prepared->panels.end(),
+                                           [](auto &target) { return !target->src->good(); });
+                if (failed != prepared->panels.end()) {
+                    // the new panels were never scheduled, so dropping them leaves capture untouched
+                    auto &device = (*failed)->device;
+                    std::cerr << "Could not open " << (device.empty() ? "the default source" : device)
+                              << ", keeping the previous configuration" << std::endl;
+                    continue;
+                }
+            } else if (next.gravity != current.gravity) {
+                for (size_t i = 0; i < next.devices.size(); i++) {
+                    prepared->filters.push_back(make_filters(next));
+                }
+            }
+            if (next.workers != current.workers || next.vsync != current.vsync || next.realtime != current.realtime
+                || next.realtime_policy != current.realtime_policy
+                || next.realtime_priority != current.realtime_priority || next.lock_memory != current.lock_memory
+                || next.audio_cpu != current.audio_cpu || next.render_cpu != current.render_cpu
+                || next.software_rendering != current.software_rendering) {
+                std::cerr << "Changes to workers, vsync, real-time scheduling, CPU pinning and software_rendering take "
+                             "effect after a restart"
+                          << std::endl;
+            }
+            prepared->next = next;
+            current = std::move(next);
+            std::lock_guard _(slot.lock);
+            slot.pending = std::move(prepared);
+        }
+    }
+} // namespace visualize
 
-        visualize::audio_thread(run, buf, std::make_unique<visualize::config::source>(buf.data_size * 2), filters);
+int main(int argc, char **argv) {
+    visualize::arguments args;
+    if (!visualize::parse_args(argc, argv, args)) {
+        std::cerr << "usage: " << argv[0] << " [--config <file>] [--<setting> <value>]...\n"
+                  << "       [--dump <rgb|y4m|ppm> --input <file.wav> [--output <path>] [--size <w>x<h>] [--fps <n>]]"
+                  << std::endl;
+        return 2;
+    }
+    visualize::settings config;
+    if (!visualize::load_settings(args, config)) {
+        return 2;
+    }
+    if (args.headless) {
+        auto &options = args.options;
+        options.resolution = config.resolution;
+        options.barcount = config.barcount;
+        options.gravity = config.gravity;
+        auto pack = [](visualize::color c) { return uint32_t(c.r) << 16 | uint32_t(c.g) << 8 | c.b; };
+        options.foreground = pack(config.foreground);
+        options.background = pack(config.background);
+        return visualize::render_headless(options);
+    }
+    if (config.realtime && config.lock_memory) {
+        visualize::lock_memory();
+    }
+    std::atomic_bool run = true;
+    auto workers = config.workers;
+    if (workers == 0) {
+        workers = config.parallel ? std::max<size_t>(std::thread::hardware_concurrency(), config.devices.size())
+                                  : config.devices.size();
+    }
+    auto pool = std::make_unique<visualize::worker_pool>(workers, [config](size_t index) {
+        // with a worker per core the later ones would run past the last CPU, those stay unpinned
+        int cpu = config.audio_cpu < 0 ? -1 : config.audio_cpu + int(index);
+        visualize::pin_thread(cpu < int(std::thread::hardware_concurrency()) ? cpu : -1);
+        if (config.realtime) {
+            visualize::set_realtime_priority(config.realtime_policy, config.realtime_priority);
+            if (config.lock_memory) {
+                visualize::prefault_stack(256 * 1024);
+            }
+        }
     });
+    std::vector<std::shared_ptr<visualize::panel>> panels;
+    for (auto &device : config.devices) {
+        panels.push_back(visualize::make_panel(config, device, *pool));
+        visualize::schedule(*pool, panels.back(), run);
+    }
+    visualize::reload_slot reloads;
+    std::thread watcher;
+    if (!args.config_path.empty()) {
+        watcher = std::thread(visualize::watch_settings, std::cref(args), config, std::ref(*pool), std::ref(reloads),
+                              std::ref(run));
+    }
+
+    visualize::pin_thread(config.render_cpu);
     SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS);
-    auto window = SDL_CreateWindow("Visualizer", 100, 100, 800, 480, visualize::config.window_flags);
-    auto renderer = SDL_CreateRenderer(window, -1, visualize::config.renderer_flags);
-    auto bars = std::make_unique<double[]>(size_t(visualize::config.barcount));
+    auto window = SDL_CreateWindow("Visualizer", 100, 100, 800, 480,
+                                   SDL_WINDOW_RESIZABLE | (config.fullscreen ? SDL_WINDOW_FULLSCREEN : 0u));
+    SDL_Renderer *renderer = nullptr;
+    if (!config.software_rendering) {
+        renderer = SDL_CreateRenderer(window, -1,
+                                      SDL_RENDERER_ACCELERATED | (config.vsync ? SDL_RENDERER_PRESENTVSYNC : 0u));
+        if (!bool(renderer)) {
+            std::cerr << "No renderer available (" << SDL_GetError() << "), drawing on the CPU" << std::endl;
+        }
+    }
+    std::unique_ptr<visualize::surface_presenter> presenter;
+    if (!bool(renderer)) {
+        presenter = std::make_unique<visualize::surface_presenter>(window);
+        if (!presenter->reset(config.foreground, config.background)) {
+            run.store(false, std::memory_order_relaxed);
+        }
+    }
+    auto frame_time = std::chrono::microseconds(1000000 / config.software_fps);
+    auto next_frame = std::chrono::steady_clock::now();
+    std::unique_ptr<double[]> bars;
+    std::unique_ptr<SDL_Rect[]> rects, areas;
+    visualize::frame latest;
 
     int width, height;
-    auto rects = std::make_unique<SDL_Rect[]>(size_t(visualize::config.barcount));
     SDL_GetWindowSize(window, &width, &height);
-    visualize::rescale_rects(rects, width);
+    auto layout = [&]() {
+        auto count = config.barcount * panels.size();
+        bars = std::make_unique<double[]>(count);
+        rects = std::make_unique<SDL_Rect[]>(count);
+        areas = std::make_unique<SDL_Rect[]>(panels.size());
+        visualize::rescale_rects(rects, areas, panels.size(), config.barcount, width, height);
+    };
+    layout();
+    // only ever runs between two frames, so nothing is drawn with a mix of old and new settings
+    auto apply = [&](visualize::reload &next) {
+        bool relayout = !next.panels.empty() || next.next.barcount != config.barcount;
+        bool recolor = next.next.foreground != config.foreground || next.next.background != config.background;
+        if (!next.panels.empty()) {
+            for (auto &old : panels) {
+                // a producer blocked on its full queue has to be released before it can notice
+                old->active.store(false, std::memory_order_relaxed);
+                old->queue->close();
+            }
+            panels = std::move(next.panels);
+            for (auto &target : panels) {
+                visualize::schedule(*pool, target, run);
+            }
+        }
+        for (size_t p = 0; p < next.filters.size(); p++) {
+            panels[p]->pipe->set_filters(std::move(next.filters[p]));
+        }
+        if (next.next.fullscreen != config.fullscreen) {
+            SDL_SetWindowFullscreen(window, next.next.fullscreen ? SDL_WINDOW_FULLSCREEN : 0);
+        }
+        config = std::move(next.next);
+        frame_time = std::chrono::microseconds(1000000 / config.software_fps);
+        if (relayout) {
+            layout();
+        }
+        if ((relayout || recolor) && bool(presenter) && !presenter->reset(config.foreground, config.background)) {
+            run.store(false, std::memory_order_relaxed);
+        }
+    };
     while (run.load(std::memory_order_relaxed)) {
+        std::unique_ptr<visualize::reload> next;
+        {
+            std::lock_guard _(reloads.lock);
+            next = std::move(reloads.pending);
+        }
+        if (bool(next)) {
+            apply(*next);
+        }
+        // without a configuration file to fix the devices in, there's nothing left to show once all of them failed
+        if (!watcher.joinable()
+            && std::none_of(panels.begin(), panels.end(),
+                            [](auto &target) { return target->active.load(std::memory_order_relaxed); })) {
+            break;
+        }
+
         SDL_Event event;
         while (bool(SDL_PollEvent(&event))) {
             switch (event.type) {
             case SDL_QUIT: run.store(false, std::memory_order_relaxed); break;
             case SDL_WINDOWEVENT: {
-                if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
+                auto kind = event.window.event;
+                if (kind == SDL_WINDOWEVENT_RESIZED || kind == SDL_WINDOWEVENT_SIZE_CHANGED) {
                     width = event.window.data1;
                     height = event.window.data2;
-                    visualize::rescale_rects(rects, width);
+                    visualize::rescale_rects(rects, areas, panels.size(), config.barcount, width, height);
+                    if (bool(presenter) && !presenter->reset(config.foreground, config.background)) {
+                        run.store(false, std::memory_order_relaxed);
+                    }
+                } else if (kind == SDL_WINDOWEVENT_EXPOSED && bool(presenter) && !presenter->invalidate()) {
+                    // only the dirty rows are presented, anything the window system lost has to be drawn again
+                    run.store(false, std::memory_order_relaxed);
                 }
                 break;
             }
@@ -156,22 +565,36 @@ int main() {
             }
             }
         }
-        auto [foreground, background] = std::tie(visualize::config.foreground, visualize::config.background);
-        SDL_SetRenderDrawColor(renderer, background.r, background.g, background.b, SDL_ALPHA_OPAQUE);
-        SDL_RenderClear(renderer);
-        SDL_SetRenderDrawColor(renderer, foreground.r, foreground.g, foreground.b, SDL_ALPHA_OPAQUE);
+        auto barcount = config.barcount;
+        for (size_t p = 0; p < panels.size(); p++) {
+            // without a new frame the panel keeps showing the previous one
+            if (panels[p]->queue->try_pop(latest)) {
+                visualize::calculate_bars(&bars[p * barcount], barcount, latest.data.data(), latest.data.size());
+            }
 
-        {
-            auto [buffer, _] = buf.acquire();
-            visualize::calculate_bars(bars.get(), visualize::config.barcount, buffer, buf.data_size);
+            auto &area = areas[p];
+            for (size_t i = p * barcount; i < (p + 1) * barcount; i++) {
+                rects[i].h = static_cast<int>(bars[i] * area.h);
+                rects[i].y = area.y + area.h - rects[i].h;
+            }
         }
 
-        for (size_t i = 0; i < size_t(visualize::config.barcount); i++) {
-            rects[i].h = static_cast<int>(bars[i] * height);
-            rects[i].y = height - rects[i].h;
+        if (bool(presenter)) {
+            if (!presenter->present(rects.get(), barcount * panels.size())) {
+                run.store(false, std::memory_order_relaxed);
+                break;
+            }
+            // a late frame doesn't get made up for with a burst of frames
+            next_frame = std::max(next_frame + frame_time, std::chrono::steady_clock::now());
+            std::this_thread::sleep_until(next_frame);
+            continue;
         }
 
-        if (SDL_RenderFillRects(renderer, rects.get(), int(visualize::config.barcount)) < 0) {
+        auto [foreground, background] = std::tie(config.foreground, config.background);
+        SDL_SetRenderDrawColor(renderer, background.r, background.g, background.b, SDL_ALPHA_OPAQUE);
+        SDL_RenderClear(renderer);
+        SDL_SetRenderDrawColor(renderer, foreground.r, foreground.g, foreground.b, SDL_ALPHA_OPAQUE);
+        if (SDL_RenderFillRects(renderer, rects.get(), int(barcount * panels.size())) < 0) {
             std::cerr << SDL_GetError() << std::endl;
             run.store(false, std::memory_order_relaxed);
             break;
@@ -179,9 +602,35 @@ int main() {
 
         SDL_RenderPresent(renderer);
     }
-    SDL_DestroyRenderer(renderer);
+    run.store(false, std::memory_order_relaxed);
+    if (watcher.joinable()) {
+        watcher.join();
+    }
+    presenter.reset();
+    if (bool(renderer)) {
+        SDL_DestroyRenderer(renderer);
+    }
     SDL_DestroyWindow(window);
     SDL_QuitSubSystem(SDL_INIT_EVERYTHING);
     SDL_Quit();
-    audio_thread.join();
+    // producers blocked on a full queue have to be released before the pool can finish
+    for (auto &target : panels) {
+        target->queue->close();
+    }
+    pool.reset();
+    for (size_t p = 0; p < panels.size(); p++) {
+        auto stats = panels[p]->queue->stats();
+        // every panel's source is made by make_panel
+        auto skips = static_cast<visualize::source *>(panels[p]->src)->skips();
+        if (stats.dropped + stats.coalesced + stats.skipped + stats.blocked + skips != 0) {
+            std::cout << "Pipeline " << p << ": " << stats.pushed << " frames published, " << stats.popped
+                      << " rendered, " << stats.dropped << " dropped, " << stats.coalesced << " coalesced, "
+                      << stats.skipped << " skipped by the renderer, " << stats.blocked << " blocked, " << skips
+                      << " capture skips" << std::endl;
+        }
+        if (config.realtime) {
+            std::cout << "Pipeline " << p << ": ";
+            panels[p]->pipe->jitter().print(std::cout);
+        }
+    }
 }
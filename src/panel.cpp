@@ -0,0 +1,33 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "panel.hpp"
+#include <iostream>
+
+void visualize::schedule(worker_pool &pool, std::shared_ptr<panel> target, std::atomic_bool &run) {
+    pool.submit([&pool, target = std::move(target), &run]() mutable {
+        if (!run.load(std::memory_order_relaxed) || !target->active.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (!target->pipe->step()) {
+            std::cerr << "Capture from " << (target->device.empty() ? "the default source" : target->device)
+                      << " failed, its panel stops updating" << std::endl;
+            target->active.store(false, std::memory_order_relaxed);
+            return;
+        }
+        schedule(pool, std::move(target), run);
+    });
+}
@@ -0,0 +1,208 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "pipeline.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace {
+    //! only fftw_execute is thread safe, the planner has to be serialized
+    std::mutex planner_lock;
+} // namespace
+
+struct visualize::pipeline::chunk_work {
+    worker_pool *pool;
+    size_t chunk_bins, count;
+    //! next chunk to be claimed and chunks finished. a task that claims an index past \p count is done
+    std::atomic_size_t next, done;
+
+    // set up by the stepping thread before the frame's chunks are released
+    pipeline *owner = nullptr;
+    double *data = nullptr;
+    size_t partitioned = 0;
+    //! per chunk, merged in chunk order so the results don't depend on which thread ran what
+    std::vector<feature_tracker::sums> sums;
+    //! per chunk and partitioned filter
+    std::vector<double> reductions;
+
+    chunk_work(worker_pool *pool, size_t chunk_bins, size_t resolution) :
+        pool(pool),
+        chunk_bins(chunk_bins),
+        count((resolution + chunk_bins - 1) / chunk_bins),
+        next(count),
+        done(count),
+        sums(count) {}
+
+    void run() {
+        for (size_t index; (index = next.fetch_add(1, std::memory_order_acq_rel)) < count;) {
+            owner->process_chunk(index);
+            done.fetch_add(1, std::memory_order_release);
+        }
+    }
+};
+
+visualize::pipeline::pipeline(size_t resolution, std::unique_ptr<data_source> src,
+                              std::vector<std::unique_ptr<filter>> filters, const parallel_options &parallel) :
+    output(resolution),
+    src(std::move(src)),
+    filters(std::move(filters)),
+    fftw_in(std::make_unique<double[]>(resolution * 2)),
+    fftw_out(std::make_unique<fftw_complex[]>(resolution + 1)),
+    features(resolution) {
+    if (bool(parallel.pool) && resolution > parallel.chunk_bins) {
+        chunks = std::make_shared<chunk_work>(parallel.pool, std::max<size_t>(parallel.chunk_bins, 1), resolution);
+        chunks->owner = this;
+    }
+    std::lock_guard _(planner_lock);
+#ifdef HAVE_FFTW3_THREADS
+    // the thread count is planner state, it's only raised while this plan is made
+    static const bool threads_ready = fftw_init_threads() != 0;
+    fftw_plan_with_nthreads(threads_ready ? std::max(parallel.fft_threads, 1) : 1);
+#else
+    if (parallel.fft_threads > 1) {
+        std::cerr << "fftw was built without thread support, transforming on one thread" << std::endl;
+    }
+#endif
+    // plans of the same size reuse the wisdom gathered by the first one, so measuring only happens once per process
+    plan = fftw_plan_dft_r2c_1d(int(resolution * 2), fftw_in.get(), fftw_out.get(), FFTW_MEASURE);
+#ifdef HAVE_FFTW3_THREADS
+    fftw_plan_with_nthreads(1);
+#endif
+}
+
+visualize::pipeline::~pipeline() {
+    std::lock_guard _(planner_lock);
+    fftw_destroy_plan(plan);
+}
+
+void visualize::pipeline::set_filters(std::vector<std::unique_ptr<filter>> filters) {
+    // a chain step hasn't picked up yet is dropped unused, otherwise this is the one it swapped out
+    std::vector<std::unique_ptr<filter>> retired;
+    std::lock_guard _(filters_lock);
+    retired = std::move(next_filters);
+    next_filters = std::move(filters);
+    filters_changed.store(true, std::memory_order_release);
+}
+
+void visualize::pipeline::process_chunk(size_t index) {
+    auto &work = *chunks;
+    auto begin = index * work.chunk_bins, end = std::min(begin + work.chunk_bins, output.data_size);
+    auto *data = work.data;
+    // neighbouring chunks' sums share cache lines, so they're only written once the chunk is done
+    feature_tracker::sums sums;
+    for (size_t i = begin; i < end; i++) {
+        data[i] = hypot(fftw_out[i][0], fftw_out[i][1]);
+        features.accumulate(sums, i, data[i]);
+    }
+    work.sums[index] = sums;
+    // the whole partitionable part of the chain runs while the chunk is still in cache
+    for (size_t f = 0; f < work.partitioned; f++) {
+        work.reductions[index * work.partitioned + f] = filters[f]->apply_range(data, begin, end);
+    }
+}
+
+size_t visualize::pipeline::process_chunks(double *data) {
+    auto &work = *chunks;
+    work.data = data;
+    work.partitioned = size_t(std::find_if(filters.begin(), filters.end(), [](auto &f) { return !f->partitionable(); })
+                              - filters.begin());
+    // only grows when a longer chain is swapped in
+    work.reductions.resize(work.count * work.partitioned);
+    work.done.store(0, std::memory_order_relaxed);
+    work.next.store(0, std::memory_order_release);
+
+    // only sleeping workers are asked to help. with every worker stepping a pipeline, help queued behind them would
+    // never run, and this thread does all the chunks itself
+    for (size_t i = 0; i + 1 < work.count; i++) {
+        // a task that starts late finds nothing left, or helps with a later frame, and keeps the state alive
+        if (!work.pool->try_submit([work = chunks]() { work->run(); })) {
+            break;
+        }
+    }
+    work.run();
+    // everything left is being worked on by now, so this wait is short
+    while (work.done.load(std::memory_order_acquire) < work.count) {
+        std::this_thread::yield();
+    }
+
+    for (auto &sums : work.sums) {
+        features.merge(sums);
+    }
+    for (size_t f = 0; f < work.partitioned; f++) {
+        double total = 0;
+        for (size_t index = 0; index < work.count; index++) {
+            total += work.reductions[index * work.partitioned + f];
+        }
+        filters[f]->reduce(total);
+    }
+    return work.partitioned;
+}
+
+bool visualize::pipeline::step() {
+    using clock = std::chrono::steady_clock;
+    if (!src->grab_audio(fftw_in.get())) {
+        return false;
+    }
+    auto wakeup = clock::now();
+    if (filters_changed.exchange(false, std::memory_order_acquire)) {
+        std::lock_guard _(filters_lock);
+        std::swap(filters, next_filters);
+    }
+    if (first_step) {
+        first_wakeup = wakeup;
+    }
+    auto time = frame_rate > 0 ? double(output.sequence) / frame_rate
+                               : std::chrono::duration<double>(wakeup - first_wakeup).count();
+    fftw_execute(plan);
+    const double *published;
+    uint64_t sequence;
+    spectral_features published_features;
+    {
+        auto [data, _] = output.acquire();
+        features.begin();
+        size_t applied = 0;
+        if (bool(chunks)) {
+            applied = process_chunks(data);
+        } else {
+            for (size_t i = 0; i < output.data_size; i++) {
+                data[i] = hypot(fftw_out[i][0], fftw_out[i][1]);
+                features.accumulate(i, data[i]);
+            }
+        }
+        output.features = features.finish(time);
+        for (size_t f = applied; f < filters.size(); f++) {
+            filters[f]->apply(data);
+        }
+        output.sequence++;
+        output.captured = wakeup;
+        published = data;
+        sequence = output.sequence;
+        published_features = output.features;
+    }
+    // only this thread writes to the buffer, so it can be read without holding the lock while the queue blocks
+    if (bool(queue)) {
+        queue->push(published, sequence, wakeup, published_features);
+    }
+    if (!first_step) {
+        wakeup_jitter.record(wakeup - last_wakeup, clock::now() - wakeup);
+    }
+    first_step = false;
+    last_wakeup = wakeup;
+    return true;
+}
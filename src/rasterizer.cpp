@@ -0,0 +1,93 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "rasterizer.hpp"
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+void visualize::fill_row(uint32_t *row, size_t count, uint32_t color) {
+    size_t i = 0;
+#ifdef __SSE2__
+    auto wide = _mm_set1_epi32(int(color));
+    // unaligned stores are as fast as aligned ones on anything recent, so there's no peeling loop
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&row[i]), wide);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&row[i + 4]), wide);
+    }
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&row[i]), wide);
+    }
+#endif
+    for (; i < count; i++) {
+        row[i] = color;
+    }
+}
+
+visualize::rasterizer::rasterizer(uint32_t foreground, uint32_t background) :
+    foreground(foreground),
+    background(background) {}
+
+void visualize::rasterizer::target(uint32_t *pixels, size_t pitch, int width, int height) {
+    this->pixels = pixels;
+    this->pitch = pitch;
+    this->width = width;
+    this->height = height;
+    previous.clear();
+    fill({ 0, 0, width, height }, background);
+}
+
+visualize::rasterizer::rect visualize::rasterizer::fill(const rect &area, uint32_t color) {
+    int x0 = std::max(area.x, 0), x1 = std::min(area.x + area.w, width);
+    int y0 = std::max(area.y, 0), y1 = std::min(area.y + area.h, height);
+    if (x0 >= x1 || y0 >= y1) {
+        return { 0, 0, 0, 0 };
+    }
+    for (int y = y0; y < y1; y++) {
+        fill_row(&pixels[size_t(y) * pitch + size_t(x0)], size_t(x1 - x0), color);
+    }
+    return { x0, y0, x1 - x0, y1 - y0 };
+}
+
+void visualize::rasterizer::draw(const rect *bars, size_t count, std::vector<rect> &dirty) {
+    dirty.clear();
+    auto mark = [&dirty](const rect &area) {
+        if (area.w > 0) {
+            dirty.push_back(area);
+        }
+    };
+    if (previous.size() != count) {
+        // a new layout starts out as empty bars resting on the bottom edge of the old one
+        previous.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            previous[i] = { bars[i].x, bars[i].y + bars[i].h, bars[i].w, 0 };
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        auto &now = bars[i];
+        auto &old = previous[i];
+        if (now.x != old.x || now.w != old.w || now.y + now.h != old.y + old.h) {
+            mark(fill(old, background));
+            mark(fill(now, foreground));
+        } else if (now.h > old.h) {
+            mark(fill({ now.x, now.y, now.w, now.h - old.h }, foreground));
+        } else if (now.h < old.h) {
+            mark(fill({ now.x, old.y, now.w, old.h - now.h }, background));
+        }
+        old = now;
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "realtime.hpp"
+#include <algorithm>
+#include <alloca.h>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+bool visualize::set_realtime_priority(int policy, int priority) {
+    sched_param param {};
+    param.sched_priority = priority;
+    int err = pthread_setschedparam(pthread_self(), policy, &param);
+    if (err == EPERM) {
+        // unprivileged users may still be granted a limited real-time priority through RLIMIT_RTPRIO
+        rlimit limit {};
+        if (getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_cur > 0) {
+            param.sched_priority = std::min(priority, int(limit.rlim_cur));
+            err = pthread_setschedparam(pthread_self(), policy, &param);
+        }
+    }
+    if (err != 0) {
+        std::cerr << "Real-time scheduling unavailable: " << strerror(err) << std::endl;
+        return false;
+    }
+    std::cout << "Real-time scheduling enabled with priority " << param.sched_priority << std::endl;
+    return true;
+}
+
+bool visualize::pin_thread(int cpu) {
+    if (cpu < 0) {
+        return true;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(size_t(cpu), &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        std::cerr << "Could not pin thread to CPU " << cpu << ": " << strerror(err) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool visualize::lock_memory() {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        std::cerr << "Could not lock memory: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void visualize::prefault_stack(size_t size) {
+    auto page = size_t(sysconf(_SC_PAGESIZE));
+    auto stack = static_cast<volatile unsigned char *>(alloca(size));
+    for (size_t i = 0; i < size; i += page) {
+        stack[i] = 0;
+    }
+}
+
+void visualize::jitter_histogram::record(std::chrono::nanoseconds interval, std::chrono::nanoseconds busy) {
+    count++;
+    mean_interval += (double(interval.count()) - mean_interval) / double(count);
+    if (double(busy.count()) > mean_interval) {
+        missed++;
+    }
+
+    auto jitter = std::chrono::nanoseconds(int64_t(std::abs(double(interval.count()) - mean_interval)));
+    worst = std::max(worst, jitter);
+    auto micros = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(jitter).count());
+    size_t bucket = 0;
+    while (micros != 0 && bucket < bucket_count - 1) {
+        micros >>= 1;
+        bucket++;
+    }
+    buckets[bucket]++;
+}
+
+void visualize::jitter_histogram::print(std::ostream &os) const {
+    using namespace std::chrono;
+    os << "Wakeup jitter over " << count << " periods of " << mean_interval / 1000 << "us, worst "
+       << duration_cast<microseconds>(worst).count() << "us, " << missed << " missed deadlines" << std::endl;
+    for (size_t i = 0; i < bucket_count; i++) {
+        if (buckets[i] == 0) {
+            continue;
+        }
+        if (i == bucket_count - 1) {
+            os << "  >= " << (uint64_t(1) << (i - 1));
+        } else {
+            os << "  < " << (uint64_t(1) << i);
+        }
+        os << "us: " << buckets[i] << std::endl;
+    }
+}
@@ -0,0 +1,291 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "settings.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <poll.h>
+#include <sstream>
+#include <sys/inotify.h>
+#include <type_traits>
+#include <unistd.h>
+
+namespace {
+    constexpr std::array keys = { "gravity",         "barcount",          "resolution",     "background",
+                                  "foreground",      "devices",           "workers",        "fullscreen",
+                                  "vsync",           "realtime",          "realtime_policy", "realtime_priority",
+                                  "lock_memory",     "audio_cpu",         "render_cpu",     "software_rendering",
+                                  "software_fps",    "handoff_frames",    "handoff_policy", "handoff_format",
+                                  "latency_budget",  "parallel",          "fft_threads",    "chunk_bins" };
+
+    std::string trim(const std::string &s) {
+        auto begin = s.find_first_not_of(" \t\r");
+        if (begin == std::string::npos) {
+            return "";
+        }
+        return s.substr(begin, s.find_last_not_of(" \t\r") - begin + 1);
+    }
+
+    //! std::stod and friends accept trailing garbage, these don't
+    template<typename T, typename F>
+    bool parse_number(const std::string &value, F &&convert, T &out) try {
+        size_t end = 0;
+        auto parsed = convert(value, &end);
+        if (end != value.size()) {
+            return false;
+        }
+        out = T(parsed);
+        return true;
+    } catch (const std::logic_error &) {
+        return false;
+    }
+
+    bool parse(const std::string &value, double &out) {
+        return parse_number(value, [](auto &v, size_t *end) { return std::stod(v, end); }, out);
+    }
+
+    bool parse(const std::string &value, int &out) {
+        return parse_number(value, [](auto &v, size_t *end) { return std::stoi(v, end); }, out);
+    }
+
+    template<typename T>
+    std::enable_if_t<std::is_unsigned_v<T> && !std::is_same_v<T, bool>, bool> parse(const std::string &value, T &out) {
+        return value.find('-') == std::string::npos
+               && parse_number(value, [](auto &v, size_t *end) { return std::stoull(v, end); }, out);
+    }
+
+    bool parse(const std::string &value, bool &out) {
+        if (value == "true" || value == "yes" || value == "on" || value == "1") {
+            out = true;
+        } else if (value == "false" || value == "no" || value == "off" || value == "0") {
+            out = false;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    bool parse(const std::string &value, visualize::color &out) {
+        unsigned long rgb = 0;
+        if (value.size() != 7 || value[0] != '#'
+            || !parse_number(value.substr(1), [](auto &v, size_t *end) { return std::stoul(v, end, 16); }, rgb)) {
+            return false;
+        }
+        out = { uint8_t(rgb >> 16), uint8_t(rgb >> 8), uint8_t(rgb) };
+        return true;
+    }
+
+    bool parse(const std::string &value, std::vector<std::string> &out) {
+        std::vector<std::string> devices;
+        std::istringstream list(value);
+        for (std::string device; std::getline(list, device, ',');) {
+            device = trim(device);
+            devices.push_back(device == "default" ? "" : device);
+        }
+        if (devices.empty()) {
+            return false;
+        }
+        out = std::move(devices);
+        return true;
+    }
+
+    template<typename T, size_t N>
+    bool parse_name(const std::string &value, const std::array<std::pair<const char *, T>, N> &names, T &out) {
+        auto match = std::find_if(names.begin(), names.end(), [&value](auto &name) { return value == name.first; });
+        if (match == names.end()) {
+            return false;
+        }
+        out = match->second;
+        return true;
+    }
+} // namespace
+
+bool visualize::settings::known(const std::string &key) {
+    return std::find(keys.begin(), keys.end(), key) != keys.end();
+}
+
+bool visualize::settings::set(const std::string &key, const std::string &value, std::string &error) {
+    using policy = overflow_policy;
+    bool ok = false;
+    if (key == "gravity") {
+        ok = parse(value, gravity);
+    } else if (key == "barcount") {
+        ok = parse(value, barcount);
+    } else if (key == "resolution") {
+        ok = parse(value, resolution);
+    } else if (key == "background") {
+        ok = parse(value, background);
+    } else if (key == "foreground") {
+        ok = parse(value, foreground);
+    } else if (key == "devices") {
+        ok = parse(value, devices);
+    } else if (key == "workers") {
+        ok = parse(value, workers);
+    } else if (key == "fullscreen") {
+        ok = parse(value, fullscreen);
+    } else if (key == "vsync") {
+        ok = parse(value, vsync);
+    } else if (key == "realtime") {
+        ok = parse(value, realtime);
+    } else if (key == "realtime_policy") {
+        ok = parse_name(value, std::array { std::pair { "fifo", SCHED_FIFO }, std::pair { "rr", SCHED_RR } },
+                        realtime_policy);
+    } else if (key == "realtime_priority") {
+        ok = parse(value, realtime_priority);
+    } else if (key == "lock_memory") {
+        ok = parse(value, lock_memory);
+    } else if (key == "audio_cpu") {
+        ok = parse(value, audio_cpu);
+    } else if (key == "render_cpu") {
+        ok = parse(value, render_cpu);
+    } else if (key == "software_rendering") {
+        ok = parse(value, software_rendering);
+    } else if (key == "software_fps") {
+        ok = parse(value, software_fps);
+    } else if (key == "handoff_frames") {
+        ok = parse(value, handoff_frames);
+    } else if (key == "handoff_policy") {
+        ok = parse_name(value,
+                        std::array { std::pair { "block", policy::block },
+                                     std::pair { "drop_oldest", policy::drop_oldest },
+                                     std::pair { "coalesce_max", policy::coalesce_max },
+                                     std::pair { "coalesce_mean", policy::coalesce_mean },
+                                     std::pair { "catch_up", policy::catch_up } },
+                        handoff_policy);
+    } else if (key == "handoff_format") {
+        ok = parse_name(value,
+                        std::array { std::pair { "none", compact_format::none },
+                                     std::pair { "linear16", compact_format::linear16 },
+                                     std::pair { "log8", compact_format::log8 } },
+                        handoff_format);
+    } else if (key == "latency_budget") {
+        ok = parse(value, latency_budget);
+    } else if (key == "parallel") {
+        ok = parse(value, parallel);
+    } else if (key == "fft_threads") {
+        ok = parse(value, fft_threads);
+    } else if (key == "chunk_bins") {
+        ok = parse(value, chunk_bins);
+    } else {
+        error = "unknown setting \"" + key + "\"";
+        return false;
+    }
+    if (!ok) {
+        error = "invalid value \"" + value + "\" for " + key;
+    }
+    return ok;
+}
+
+bool visualize::settings::validate(std::string &error) const {
+    if (resolution == 0 || resolution > size_t(INT_MAX / 2)) {
+        error = "resolution out of range";
+    } else if (barcount == 0 || barcount > resolution) {
+        error = "barcount has to be between 1 and the resolution";
+    } else if (gravity < 0) {
+        error = "gravity can't be negative";
+    } else if (software_fps <= 0) {
+        error = "software_fps has to be positive";
+    } else if (handoff_frames == 0) {
+        error = "handoff_frames has to be positive";
+    } else if (fft_threads <= 0 || chunk_bins == 0) {
+        error = "fft_threads and chunk_bins have to be positive";
+    } else {
+        return true;
+    }
+    return false;
+}
+
+bool visualize::read_settings(std::istream &in, const std::string &name, settings &out) {
+    auto next = out;
+    std::string line, error;
+    for (size_t number = 1; std::getline(in, line); number++) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        auto equals = line.find('=');
+        if (equals == std::string::npos) {
+            std::cerr << name << ':' << number << ": expected key = value" << std::endl;
+            return false;
+        }
+        if (!next.set(trim(line.substr(0, equals)), trim(line.substr(equals + 1)), error)) {
+            std::cerr << name << ':' << number << ": " << error << std::endl;
+            return false;
+        }
+    }
+    if (!next.validate(error)) {
+        std::cerr << name << ": " << error << std::endl;
+        return false;
+    }
+    out = std::move(next);
+    return true;
+}
+
+bool visualize::read_settings(const std::string &path, settings &out) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Could not open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return read_settings(in, path, out);
+}
+
+visualize::file_watcher::file_watcher(const std::string &path) {
+    auto slash = path.rfind('/');
+    auto directory = slash == std::string::npos ? std::string(".") : path.substr(0, std::max<size_t>(slash, 1));
+    name = slash == std::string::npos ? path : path.substr(slash + 1);
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "inotify_init1: " << std::strerror(errno) << std::endl;
+        return;
+    }
+    if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cerr << "Could not watch " << directory << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        fd = -1;
+    }
+}
+
+visualize::file_watcher::~file_watcher() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool visualize::file_watcher::wait(std::chrono::milliseconds timeout) {
+    pollfd waiting { fd, POLLIN, 0 };
+    if (fd < 0 || poll(&waiting, 1, int(timeout.count())) <= 0) {
+        return false;
+    }
+    bool changed = false;
+    alignas(inotify_event) char events[4096];
+    ssize_t length;
+    while ((length = read(fd, events, sizeof(events))) > 0) {
+        for (auto *at = events; at < events + length;) {
+            auto *event = reinterpret_cast<const inotify_event *>(at);
+            if (event->len > 0 && name == event->name) {
+                changed = true;
+            }
+            at += sizeof(inotify_event) + event->len;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,343 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "data_sources/generator.hpp"
+#include "filters/clip_filter.hpp"
+#include "filters/peek_filter.hpp"
+#include "filters/sagc_filter.hpp"
+#include "panel.hpp"
+#include "pipeline.hpp"
+#include "postprocessing.hpp"
+#include "settings.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    using clock = std::chrono::steady_clock;
+
+    struct options {
+        double duration = 60;
+        size_t pipelines = 1;
+        size_t resolution = 2048;
+        size_t barcount = 160;
+        double fps = 60;
+        //! seconds between two progress reports, the first period is also the warmup
+        double report_interval = 10;
+        visualize::generator_source::signal signal = visualize::generator_source::signal::pink_noise;
+        bool paced = true;
+        //! handoff to the consumer and splitting of the work, only those members of the visualizer's settings are used
+        visualize::settings config;
+
+        // regression thresholds, negative values disable a check
+        double min_fps = -1;
+        double max_drop = -1;
+        double max_drift_ms = -1;
+        double max_growth_mb = -1;
+    };
+
+    const std::map<std::string, visualize::generator_source::signal> signals {
+        { "silence", visualize::generator_source::signal::silence },
+        { "sine", visualize::generator_source::signal::sine },
+        { "sweep", visualize::generator_source::signal::sweep },
+        { "multitone", visualize::generator_source::signal::multitone },
+        { "white", visualize::generator_source::signal::white_noise },
+        { "pink", visualize::generator_source::signal::pink_noise },
+        { "impulse", visualize::generator_source::signal::impulse },
+    };
+
+    //! options passed on to \p visualize::settings::set
+    const std::array<std::string, 5> settings_args { "--handoff-frames", "--handoff-policy", "--handoff-format",
+                                                     "--fft-threads", "--chunk-bins" };
+
+    void usage(const char *argv0) {
+        std::cerr << "usage: " << argv0 << " [options]\n"
+                  << "  -d <s>               run time in seconds (default 60)\n"
+                  << "  -p <n>               concurrent pipelines (default 1)\n"
+                  << "  -r <n>               fftw output resolution (default 2048)\n"
+                  << "  -b <n>               bars per frame (default 160)\n"
+                  << "  -f <n>               render rate of the consumer (default 60)\n"
+                  << "  -i <s>               report interval, the first one is the warmup (default 10)\n"
+                  << "  -s <signal>          silence, sine, sweep, multitone, white, pink (default) or impulse\n"
+                  << "  --unpaced            generate audio as fast as possible instead of in real time\n"
+                  << "  --handoff-frames <n>, --handoff-policy <policy>, --handoff-format <format>\n"
+                  << "                       the queue between pipeline and consumer, see the visualizer's settings\n"
+                  << "  --parallel, --fft-threads <n>, --chunk-bins <n>\n"
+                  << "                       split each frame's work, see the visualizer's settings\n"
+                  << "  --min-fps <n>        fail if a pipeline produces fewer frames per second\n"
+                  << "  --max-drop <f>       fail if a larger fraction of the frames is never rendered, frames merged\n"
+                  << "                       by coalescing count as rendered\n"
+                  << "  --max-drift <ms>     fail if latency grows more than this between the first and last report\n"
+                  << "  --max-growth <MiB>   fail if resident memory grows more than this after the warmup"
+                  << std::endl;
+    }
+
+    bool parse_args(int argc, char **argv, options &opts) try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--unpaced") {
+                opts.paced = false;
+                continue;
+            }
+            if (arg == "--parallel") {
+                opts.config.parallel = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                return false;
+            }
+            std::string v = argv[++i];
+            if (std::find(settings_args.begin(), settings_args.end(), arg) != settings_args.end()) {
+                // --handoff-policy sets handoff_policy and so on
+                auto key = arg.substr(2);
+                std::replace(key.begin(), key.end(), '-', '_');
+                std::string error;
+                if (!opts.config.set(key, v, error)) {
+                    std::cerr << error << std::endl;
+                    return false;
+                }
+            } else if (arg == "-d") {
+                opts.duration = std::stod(v);
+            } else if (arg == "-p") {
+                opts.pipelines = std::stoul(v);
+            } else if (arg == "-r") {
+                opts.resolution = std::stoul(v);
+            } else if (arg == "-b") {
+                opts.barcount = std::stoul(v);
+            } else if (arg == "-f") {
+                opts.fps = std::stod(v);
+            } else if (arg == "-i") {
+                opts.report_interval = std::stod(v);
+            } else if (arg == "-s" && signals.count(v) != 0) {
+                opts.signal = signals.at(v);
+            } else if (arg == "--min-fps") {
+                opts.min_fps = std::stod(v);
+            } else if (arg == "--max-drop") {
+                opts.max_drop = std::stod(v);
+            } else if (arg == "--max-drift") {
+                opts.max_drift_ms = std::stod(v);
+            } else if (arg == "--max-growth") {
+                opts.max_growth_mb = std::stod(v);
+            } else {
+                return false;
+            }
+        }
+        std::string error;
+        if (!opts.config.validate(error)) {
+            std::cerr << error << std::endl;
+            return false;
+        }
+        return opts.pipelines > 0 && opts.barcount > 0 && opts.barcount <= opts.resolution && opts.fps > 0
+               && opts.report_interval > 0;
+    } catch (const std::logic_error &) {
+        return false;
+    }
+
+    //! resident set size of the process, in MiB
+    double resident_mb() {
+        std::ifstream statm("/proc/self/statm");
+        size_t size = 0, resident = 0;
+        statm >> size >> resident;
+        return double(resident) * double(sysconf(_SC_PAGESIZE)) / (1024 * 1024);
+    }
+
+    //! what the consumer observed during one report interval
+    struct interval_stats {
+        uint64_t rendered = 0;
+        double latency_sum = 0;
+        //! the queues' counters summed over the pipelines, for the interval or since the start
+        visualize::frame_queue::counters queued;
+
+        double mean_latency_ms() const { return rendered == 0 ? 0 : latency_sum / double(rendered) * 1000; }
+    };
+
+    visualize::frame_queue::counters operator-(visualize::frame_queue::counters a,
+                                               const visualize::frame_queue::counters &b) {
+        a.pushed -= b.pushed;
+        a.popped -= b.popped;
+        a.blocked -= b.blocked;
+        a.dropped -= b.dropped;
+        a.coalesced -= b.coalesced;
+        a.skipped -= b.skipped;
+        a.bytes -= b.bytes;
+        return a;
+    }
+
+    //! frames discarded on either side of the queue
+    uint64_t discarded(const visualize::frame_queue::counters &counts) { return counts.dropped + counts.skipped; }
+
+    visualize::frame_queue::counters total_counters(const std::vector<std::shared_ptr<visualize::panel>> &panels) {
+        visualize::frame_queue::counters total;
+        for (auto &target : panels) {
+            auto counts = target->queue->stats();
+            total.pushed += counts.pushed;
+            total.popped += counts.popped;
+            total.blocked += counts.blocked;
+            total.dropped += counts.dropped;
+            total.coalesced += counts.coalesced;
+            total.skipped += counts.skipped;
+            total.bytes += counts.bytes;
+        }
+        return total;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    options opts;
+    if (!parse_args(argc, argv, opts)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    auto &config = opts.config;
+    std::atomic_bool run = true;
+    // sized like the visualizer's pool with workers at 0
+    auto workers = config.parallel ? std::max<size_t>(std::thread::hardware_concurrency(), opts.pipelines)
+                                   : opts.pipelines;
+    auto pool = std::make_unique<visualize::worker_pool>(workers);
+    std::vector<visualize::generator_source *> generators;
+    std::vector<std::shared_ptr<visualize::panel>> panels;
+    for (size_t p = 0; p < opts.pipelines; p++) {
+        visualize::generator_source::settings settings;
+        settings.kind = opts.signal;
+        settings.paced = opts.paced;
+        settings.seed = uint32_t(p + 1);
+        auto src = std::make_unique<visualize::generator_source>(opts.resolution * 2, settings);
+        generators.push_back(src.get());
+
+        std::vector<std::unique_ptr<visualize::filter>> filters;
+        filters.emplace_back(new visualize::sagc_filter(opts.resolution));
+        filters.emplace_back(new visualize::clip_filter(opts.resolution));
+        filters.emplace_back(new visualize::peek_filter(opts.resolution, 100.0 / 6.0));
+        visualize::parallel_options parallel;
+        if (config.parallel) {
+            parallel.pool = pool.get();
+            parallel.fft_threads = config.fft_threads;
+            parallel.chunk_bins = config.chunk_bins;
+        }
+
+        auto target = std::make_shared<visualize::panel>();
+        target->device = "generator " + std::to_string(p + 1);
+        target->src = src.get();
+        target->pipe = std::make_unique<visualize::pipeline>(opts.resolution, std::move(src), std::move(filters),
+                                                             parallel);
+        target->queue = std::make_unique<visualize::frame_queue>(config.handoff_frames, opts.resolution,
+                                                                 config.handoff_policy, config.handoff_format);
+        target->pipe->set_output_queue(target->queue.get());
+        panels.push_back(target);
+        visualize::schedule(*pool, std::move(target), run);
+    }
+
+    // the consumer stands in for the render thread: it maps every pipeline to bars at a fixed rate
+    auto bars = std::make_unique<double[]>(opts.barcount);
+    visualize::frame latest;
+    std::vector<interval_stats> intervals;
+    interval_stats total, current;
+    visualize::frame_queue::counters reported;
+    double baseline_mb = 0, peak_growth_mb = 0;
+
+    auto start = clock::now();
+    auto frame_time = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1 / opts.fps));
+    auto report_time = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(opts.report_interval));
+    auto end = start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(opts.duration));
+    auto next_frame = start, next_report = start + report_time;
+    while (clock::now() < end) {
+        std::this_thread::sleep_until(next_frame);
+        next_frame += frame_time;
+        for (auto &target : panels) {
+            // like the render loop, a panel without a new frame keeps showing the previous one
+            if (!target->queue->try_pop(latest)) {
+                continue;
+            }
+            visualize::calculate_bars(bars.get(), opts.barcount, latest.data.data(), latest.data.size());
+            current.rendered++;
+            current.latency_sum += std::chrono::duration<double>(clock::now() - latest.captured).count();
+        }
+
+        if (clock::now() >= next_report) {
+            next_report += report_time;
+            auto rss = resident_mb();
+            if (intervals.empty()) {
+                baseline_mb = rss;
+            }
+            peak_growth_mb = std::max(peak_growth_mb, rss - baseline_mb);
+            auto counts = total_counters(panels);
+            current.queued = counts - reported;
+            reported = counts;
+            std::chrono::duration<double> elapsed = clock::now() - start;
+            std::cout << elapsed.count() << " s: "
+                      << double(current.rendered) / opts.report_interval / double(opts.pipelines)
+                      << " frames/s rendered per pipeline, " << discarded(current.queued) << " dropped, "
+                      << current.queued.coalesced << " coalesced, " << current.queued.blocked << " blocked, "
+                      << current.mean_latency_ms() << " ms latency, " << rss << " MiB resident" << std::endl;
+            total.rendered += current.rendered;
+            intervals.push_back(current);
+            current = {};
+        }
+    }
+    run.store(false, std::memory_order_relaxed);
+    // producers blocked on a full queue have to be released before the pool can finish
+    for (auto &target : panels) {
+        target->queue->close();
+    }
+    pool.reset();
+    std::chrono::duration<double> elapsed = clock::now() - start;
+    total.rendered += current.rendered;
+    // frames still queued when the consumer stopped were never rendered either
+    total.queued = total_counters(panels);
+
+    size_t overruns = 0;
+    for (auto *generator : generators) {
+        overruns += generator->overruns();
+    }
+    auto produced = total.queued.pushed;
+    auto fps = double(produced) / elapsed.count() / double(opts.pipelines);
+    // frames that neither reached the consumer nor were merged into one that did, including those still queued
+    auto lost = produced - total.queued.popped - total.queued.coalesced;
+    auto drop = produced == 0 ? 0 : double(lost) / double(produced);
+    // the first interval is the warmup, drift is measured from the one after it
+    double drift = intervals.size() < 3 ? 0 : intervals.back().mean_latency_ms() - intervals[1].mean_latency_ms();
+
+    std::cout << "Sustained " << fps << " frames/s per pipeline, " << drop * 100 << "% dropped, " << overruns
+              << " overruns, " << drift << " ms latency drift, " << peak_growth_mb << " MiB memory growth" << std::endl;
+    std::cout << "Queues: " << total.queued.pushed << " pushed, " << total.queued.popped << " popped, "
+              << total.queued.coalesced << " coalesced, " << total.queued.dropped << " dropped, "
+              << total.queued.skipped << " skipped, " << total.queued.blocked << " blocked pushes, "
+              << double(total.queued.bytes) / (1024 * 1024) << " MiB handed over" << std::endl;
+
+    bool failed = false;
+    auto check = [&failed](bool ok, const char *what) {
+        if (!ok) {
+            std::cerr << "FAIL: " << what << std::endl;
+            failed = true;
+        }
+    };
+    check(opts.min_fps < 0 || fps >= opts.min_fps, "frame rate below --min-fps");
+    check(opts.max_drop < 0 || drop <= opts.max_drop, "dropped frames above --max-drop");
+    check(opts.max_drift_ms < 0 || drift <= opts.max_drift_ms, "latency drift above --max-drift");
+    check(opts.max_growth_mb < 0 || peak_growth_mb <= opts.max_growth_mb, "memory growth above --max-growth");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "worker_pool.hpp"
+#include <algorithm>
+
+namespace {
+    //! index of the worker running on this thread, only valid while \p current_pool is set
+    thread_local const visualize::worker_pool *current_pool = nullptr;
+    thread_local size_t current_worker = 0;
+} // namespace
+
+visualize::worker_pool::worker_pool(size_t threads, std::function<void(size_t)> on_start) {
+    threads = std::max<size_t>(threads, 1);
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back(std::make_unique<worker>());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        this->threads.emplace_back([this, i, on_start]() {
+            current_pool = this;
+            current_worker = i;
+            if (on_start) {
+                on_start(i);
+            }
+            run(i);
+        });
+    }
+}
+
+visualize::worker_pool::~worker_pool() {
+    {
+        std::lock_guard _(sleep_lock);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+void visualize::worker_pool::submit(std::function<void()> task) {
+    size_t index = current_pool == this ? current_worker : next_worker++ % workers.size();
+    {
+        std::lock_guard _(workers[index]->lock);
+        workers[index]->tasks.emplace_back(std::move(task));
+    }
+    {
+        std::lock_guard _(sleep_lock);
+        pending++;
+    }
+    wakeup.notify_one();
+}
+
+bool visualize::worker_pool::try_submit(std::function<void()> task) {
+    {
+        std::lock_guard _(sleep_lock);
+        if (idle <= pending) {
+            return false;
+        }
+        pending++;
+    }
+    // the woken worker spins until the task shows up, see run
+    size_t index = current_pool == this ? current_worker : next_worker++ % workers.size();
+    {
+        std::lock_guard _(workers[index]->lock);
+        workers[index]->tasks.emplace_back(std::move(task));
+    }
+    wakeup.notify_one();
+    return true;
+}
+
+size_t visualize::worker_pool::queued() const {
+    std::lock_guard _(sleep_lock);
+    return pending;
+}
+
+bool visualize::worker_pool::pop(size_t index, std::function<void()> &task) {
+    {
+        auto &own = *workers[index];
+        std::lock_guard _(own.lock);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < workers.size(); i++) {
+        auto &victim = *workers[(index + i) % workers.size()];
+        std::lock_guard _(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void visualize::worker_pool::run(size_t index) {
+    std::function<void()> task;
+    while (true) {
+        {
+            std::unique_lock lock(sleep_lock);
+            idle++;
+            wakeup.wait(lock, [this]() { return pending > 0 || stopping; });
+            idle--;
+            if (pending == 0) {
+                return;
+            }
+            pending--;
+        }
+        // every reservation is backed by a queued task, but a concurrent scan may take the one this scan would find
+        while (!pop(index, task)) {
+            std::this_thread::yield();
+        }
+        task();
+        task = nullptr;
+    }
+}
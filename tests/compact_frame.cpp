@@ -0,0 +1,140 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "compact_frame.hpp"
+#include "frame_queue.hpp"
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+    //! magnitudes spread over ~120 dB, with a few exact zeros and an odd size to cover the scalar tails
+    std::vector<double> spectrum(size_t size) {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<double> decades(-6, 0);
+        std::vector<double> data(size);
+        for (auto &value : data) {
+            value = 3.5 * std::pow(10.0, decades(rng));
+        }
+        data[0] = 0;
+        data[size / 2] = 0;
+        return data;
+    }
+} // namespace
+
+TEST(compact_frame, linear16_error_bound) {
+    auto data = spectrum(1027);
+    visualize::compact_frame packed(visualize::compact_format::linear16);
+    packed.pack(data.data(), data.size());
+    ASSERT_EQ(packed.size(), data.size());
+    ASSERT_EQ(packed.bytes(), sizeof(float) + data.size() * 2);
+    ASSERT_FLOAT_EQ(packed.scale, float(*std::max_element(data.begin(), data.end())));
+
+    std::vector<double> decoded(data.size());
+    packed.unpack(decoded.data());
+    // half a code, plus the scale rounded to float
+    auto bound = packed.scale / 131070.0 + packed.scale * 1e-7;
+    for (size_t i = 0; i < data.size(); i++) {
+        ASSERT_NEAR(decoded[i], data[i], bound) << i;
+    }
+    ASSERT_EQ(decoded[0], 0);
+}
+
+TEST(compact_frame, linear16_kernels_match_scalar_rounding) {
+    // every code and the points halfway between them, through the vector body and the tail alike
+    std::vector<double> data;
+    for (int code = 0; code <= 65535; code++) {
+        data.push_back(code);
+        data.push_back(code + 0.25);
+    }
+    data.push_back(-3);
+    data.push_back(70000);
+    std::vector<uint16_t> codes(data.size());
+    visualize::pack_linear16(data.data(), data.size(), 65535, codes.data());
+    for (size_t i = 0; i + 2 < data.size(); i++) {
+        ASSERT_EQ(codes[i], uint16_t(std::lrint(data[i]))) << data[i];
+    }
+    ASSERT_EQ(codes[data.size() - 2], 0) << "negative values clamp to 0";
+    ASSERT_EQ(codes[data.size() - 1], 65535) << "values above the scale clamp to the top code";
+
+    std::vector<double> decoded(codes.size());
+    visualize::unpack_linear16(codes.data(), codes.size(), 65535, decoded.data());
+    for (size_t i = 0; i < codes.size(); i++) {
+        ASSERT_EQ(decoded[i], codes[i]);
+    }
+}
+
+TEST(compact_frame, log8_error_bound) {
+    auto data = spectrum(1027);
+    visualize::compact_frame packed(visualize::compact_format::log8);
+    packed.pack(data.data(), data.size());
+    ASSERT_EQ(packed.bytes(), sizeof(float) + data.size());
+
+    std::vector<double> decoded(data.size());
+    packed.unpack(decoded.data());
+    // half a step in dB on either side, a little slack for the float scale
+    auto ratio = std::pow(10.0, visualize::log8_range_db / 254 / 2 / 20) * (1 + 1e-6);
+    auto floor = packed.scale * std::pow(10.0, -visualize::log8_range_db / 20);
+    size_t silent = 0;
+    for (size_t i = 0; i < data.size(); i++) {
+        if (data[i] >= floor) {
+            ASSERT_LE(decoded[i], data[i] * ratio) << i;
+            ASSERT_GE(decoded[i], data[i] / ratio) << i;
+        } else if (decoded[i] == 0) {
+            silent++;
+        } else {
+            // just under the floor still rounds up to the lowest level
+            ASSERT_LE(decoded[i], data[i] * ratio) << i;
+        }
+    }
+    ASSERT_GT(silent, 2u) << "the test data reaches below the dynamic range";
+    ASSERT_EQ(decoded[0], 0);
+}
+
+TEST(compact_frame, silent_frame) {
+    std::vector<double> data(5, 0), decoded(5, 1);
+    for (auto format : { visualize::compact_format::linear16, visualize::compact_format::log8 }) {
+        visualize::compact_frame packed(format);
+        packed.pack(data.data(), data.size());
+        ASSERT_EQ(packed.scale, 0);
+        packed.unpack(decoded.data());
+        ASSERT_EQ(decoded, data);
+    }
+}
+
+TEST(compact_frame, queue_handoff) {
+    auto data = spectrum(64);
+    visualize::frame_queue queue(2, data.size(), visualize::overflow_policy::coalesce_max,
+                                 visualize::compact_format::linear16);
+    auto louder = data;
+    louder[3] = 10;
+    ASSERT_TRUE(queue.push(data.data(), 1, {}));
+    ASSERT_TRUE(queue.push(data.data(), 2, {}));
+    ASSERT_TRUE(queue.push(louder.data(), 3, {}));
+
+    visualize::frame out;
+    ASSERT_TRUE(queue.pop(out));
+    ASSERT_EQ(out.sequence, 1u);
+    for (size_t i = 0; i < data.size(); i++) {
+        ASSERT_NEAR(out.data[i], data[i], 3.5 / 65535);
+    }
+    ASSERT_TRUE(queue.try_pop(out));
+    ASSERT_EQ(out.sequence, 3u);
+    ASSERT_NEAR(out.data[3], 10, 1e-5) << "coalesced in the decoded domain";
+    ASSERT_NEAR(out.data[4], data[4], 10.0 / 65535);
+    ASSERT_EQ(queue.stats().bytes, 3 * (sizeof(float) + data.size() * 2));
+}
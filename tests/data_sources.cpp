@@ -15,8 +15,13 @@
  * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "data_source.hpp"
+#include "data_sources/generator.hpp"
+#include "data_sources/wav.hpp"
 #include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <unistd.h>
 
 struct null_source : public visualize::data_source {
     null_source(size_t size) : visualize::data_source(size), size(size) {}
@@ -47,3 +52,89 @@ TEST(data_source, null_source) {
     std::equal(std::begin(data), std::end(data), std::begin(data_expected));
     ASSERT_FALSE(src.grab_audio(data));
 }
+
+namespace {
+    /** \brief A 16 bit stereo file whose left channel counts up from 0 and whose right channel stays at 0
+     *
+     * The name carries the process id so concurrent runs don't share the file, and it's removed however the test
+     * exits.
+     */
+    struct test_wav {
+        explicit test_wav(size_t frames) {
+            auto name = "visualizer_test-" + std::to_string(::getpid()) + ".wav";
+            path = (std::filesystem::temp_directory_path() / name).string();
+            std::ofstream out(path, std::ios::binary);
+            auto u16 = [&out](uint16_t v) { out.write(reinterpret_cast<const char *>(&v), 2); };
+            auto u32 = [&out](uint32_t v) { out.write(reinterpret_cast<const char *>(&v), 4); };
+            out.write("RIFF", 4);
+            u32(uint32_t(36 + frames * 4));
+            out.write("WAVEfmt ", 8);
+            u32(16);
+            u16(1);
+            u16(2);
+            u32(44100);
+            u32(44100 * 4);
+            u16(4);
+            u16(16);
+            out.write("data", 4);
+            u32(uint32_t(frames * 4));
+            for (size_t i = 0; i < frames; i++) {
+                u16(uint16_t(i * 2));
+                u16(0);
+            }
+        }
+        ~test_wav() { std::filesystem::remove(path); }
+
+        test_wav(const test_wav &) = delete;
+        test_wav &operator=(const test_wav &) = delete;
+
+        std::string path;
+    };
+} // namespace
+
+TEST(data_source, wav_source) {
+    test_wav file(10);
+    double window[4];
+    visualize::wav_source src(file.path, std::size(window), 2);
+    ASSERT_TRUE(src.good());
+    ASSERT_EQ(src.sample_rate(), 44100u);
+
+    // channels are mixed, so every frame comes out as i / 32768
+    ASSERT_TRUE(src.grab_audio(window));
+    ASSERT_DOUBLE_EQ(window[3], 3.0 / 32768);
+    ASSERT_TRUE(src.grab_audio(window));
+    ASSERT_DOUBLE_EQ(window[0], 2.0 / 32768) << "window advances by the hop";
+    ASSERT_DOUBLE_EQ(window[3], 5.0 / 32768);
+    ASSERT_TRUE(src.grab_audio(window));
+    ASSERT_TRUE(src.grab_audio(window));
+    ASSERT_FALSE(src.grab_audio(window)) << "end of data";
+    ASSERT_EQ(src.position(), 10u);
+}
+
+TEST(data_source, generator_source) {
+    double first[64], second[64];
+    visualize::generator_source::settings settings;
+    settings.kind = visualize::generator_source::signal::pink_noise;
+    settings.length = 128;
+    visualize::generator_source a(std::size(first), settings), b(std::size(first), settings);
+    ASSERT_TRUE(a.grab_audio(first));
+    ASSERT_TRUE(b.grab_audio(second));
+    ASSERT_TRUE(std::equal(std::begin(first), std::end(first), std::begin(second))) << "same seed, same noise";
+    ASSERT_TRUE(a.grab_audio(first));
+    ASSERT_FALSE(a.grab_audio(first)) << "length exhausted";
+    ASSERT_EQ(a.position(), 128u);
+
+    settings.kind = visualize::generator_source::signal::impulse;
+    settings.impulse_interval = 32 / settings.sample_rate;
+    visualize::generator_source impulses(std::size(first), settings);
+    ASSERT_TRUE(impulses.grab_audio(first));
+    ASSERT_EQ(std::count(std::begin(first), std::end(first), settings.amplitude), 2);
+
+    settings.kind = visualize::generator_source::signal::sweep;
+    settings.sweep_duration = 0;
+    visualize::generator_source sweep(std::size(first), settings);
+    ASSERT_TRUE(sweep.grab_audio(first));
+    ASSERT_TRUE(sweep.grab_audio(first));
+    ASSERT_TRUE(std::all_of(std::begin(first), std::end(first), [](double v) { return std::isfinite(v); }))
+        << "a sweep shorter than a sample";
+}
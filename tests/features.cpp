@@ -0,0 +1,67 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "features.hpp"
+#include <gtest/gtest.h>
+#include <numeric>
+
+namespace {
+    const visualize::spectral_features &feed(visualize::feature_tracker &tracker, const std::vector<double> &spectrum,
+                                             double time) {
+        tracker.begin();
+        for (size_t i = 0; i < spectrum.size(); i++) {
+            tracker.accumulate(i, spectrum[i]);
+        }
+        return tracker.finish(time);
+    }
+} // namespace
+
+TEST(features, frame_features) {
+    visualize::feature_tracker tracker(64);
+    std::vector<double> spectrum(64, 0.0);
+    spectrum[16] = 2;
+    auto &features = feed(tracker, spectrum, 0);
+    ASSERT_DOUBLE_EQ(features.centroid, 16.0 / 64);
+    ASSERT_DOUBLE_EQ(features.flux, 2.0 / 64);
+    ASSERT_DOUBLE_EQ(std::accumulate(features.band_energy.begin(), features.band_energy.end(), 0.0), 4);
+    // 64^(5/8) < 16 < 64^(6/8)
+    ASSERT_DOUBLE_EQ(features.band_energy[5], 4);
+
+    spectrum[16] = 1;
+    ASSERT_DOUBLE_EQ(feed(tracker, spectrum, 0.01).flux, 0) << "only increases count";
+}
+
+TEST(features, onsets_and_tempo) {
+    visualize::feature_tracker tracker(32);
+    const double frame_rate = 100, beat = 0.5;
+    size_t onsets = 0;
+    double bpm = 0;
+    for (size_t n = 0; n < 1000; n++) {
+        auto time = double(n) / frame_rate;
+        bool on_beat = n % size_t(beat * frame_rate) == 0;
+        // a steady noise floor with a broadband hit on every beat
+        std::vector<double> spectrum(32, 0.1 + 0.01 * double(n % 3));
+        if (on_beat) {
+            std::fill(spectrum.begin(), spectrum.end(), 1.0);
+        }
+        auto &features = feed(tracker, spectrum, time);
+        ASSERT_TRUE(!features.onset || on_beat) << "frame " << n;
+        onsets += features.onset;
+        bpm = features.bpm;
+    }
+    ASSERT_GE(onsets, 15u);
+    ASSERT_NEAR(bpm, 60 / beat, 1);
+}
@@ -90,3 +90,20 @@ TEST(filter_tests, peek_filter) {
             << "Step " << istep.step_name;
     }
 }
+
+TEST(filter_tests, sagc_filter_ranges) {
+    // applying in ranges and reducing the partial sums has to adapt the gain exactly like a whole apply
+    double whole[std::size(test_buffer)], ranges[std::size(test_buffer)];
+    visualize::sagc_filter reference(std::size(whole)), split(std::size(ranges));
+    ASSERT_TRUE(split.partitionable());
+    for (int frame = 0; frame < 3; frame++) {
+        populate_buffer(whole);
+        populate_buffer(ranges);
+        reference.apply(whole);
+        split.reduce(split.apply_range(ranges, 0, 3) + split.apply_range(ranges, 3, 7)
+                     + split.apply_range(ranges, 7, std::size(ranges)));
+        for (size_t i = 0; i < std::size(whole); i++) {
+            ASSERT_NEAR(ranges[i], whole[i], 1e-12) << "frame " << frame << " element " << i;
+        }
+    }
+}
@@ -0,0 +1,182 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "data_sources/generator.hpp"
+#include "frame_queue.hpp"
+#include "pipeline.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(frame_queue, fifo) {
+    visualize::frame_queue queue(2, 3);
+    const double first[] = { 1, 2, 3 }, second[] = { 4, 5, 6 };
+    ASSERT_TRUE(queue.push(first, 1, {}));
+    ASSERT_TRUE(queue.push(second, 2, {}));
+
+    visualize::frame out;
+    ASSERT_TRUE(queue.pop(out));
+    ASSERT_EQ(out.sequence, 1u);
+    ASSERT_EQ(out.data, std::vector<double>(std::begin(first), std::end(first)));
+    ASSERT_TRUE(queue.pop(out));
+    ASSERT_EQ(out.sequence, 2u);
+
+    queue.close();
+    ASSERT_FALSE(queue.pop(out));
+    ASSERT_FALSE(queue.push(first, 3, {}));
+}
+
+TEST(frame_queue, producer_blocks_while_full) {
+    visualize::frame_queue queue(4, 1);
+    std::thread producer([&queue]() {
+        for (uint64_t i = 1; i <= 100; i++) {
+            double value = double(i);
+            queue.push(&value, i, {});
+        }
+        queue.close();
+    });
+    visualize::frame out;
+    uint64_t expected = 1;
+    while (queue.pop(out)) {
+        ASSERT_EQ(out.sequence, expected);
+        ASSERT_EQ(out.data[0], double(expected));
+        expected++;
+    }
+    producer.join();
+    ASSERT_EQ(expected, 101u) << "nothing is dropped";
+}
+
+namespace {
+    //! pushes single-element frames holding \p values, numbered from 1
+    void push_all(visualize::frame_queue &queue, std::initializer_list<double> values) {
+        uint64_t sequence = 1;
+        for (auto value : values) {
+            ASSERT_TRUE(queue.push(&value, sequence++, {}));
+        }
+    }
+} // namespace
+
+TEST(frame_queue, drop_oldest) {
+    visualize::frame_queue queue(2, 1, visualize::overflow_policy::drop_oldest);
+    push_all(queue, { 1, 2, 3, 4 });
+    visualize::frame out;
+    ASSERT_TRUE(queue.pop(out));
+    ASSERT_EQ(out.data[0], 3);
+    ASSERT_EQ(queue.stats().dropped, 2u);
+}
+
+TEST(frame_queue, coalesce) {
+    visualize::frame_queue max(2, 1, visualize::overflow_policy::coalesce_max);
+    push_all(max, { 1, 5, 3, 2 });
+    visualize::frame out;
+    ASSERT_TRUE(max.pop(out));
+    ASSERT_EQ(out.data[0], 1);
+    ASSERT_TRUE(max.pop(out));
+    ASSERT_EQ(out.data[0], 5);
+    ASSERT_EQ(out.sequence, 4u) << "a coalesced frame is as new as the last frame merged into it";
+    ASSERT_EQ(max.stats().coalesced, 2u);
+
+    visualize::frame_queue mean(2, 1, visualize::overflow_policy::coalesce_mean);
+    push_all(mean, { 1, 6, 3, 0 });
+    ASSERT_TRUE(mean.pop(out));
+    ASSERT_TRUE(mean.pop(out));
+    ASSERT_DOUBLE_EQ(out.data[0], 3);
+}
+
+TEST(frame_queue, coalesce_compact_while_popping) {
+    const size_t size = 1000;
+    visualize::frame_queue queue(2, size, visualize::overflow_policy::coalesce_max,
+                                 visualize::compact_format::linear16);
+    // every frame holds its own sequence number, which linear16 keeps exactly since it's the frame's scale
+    std::thread producer([&queue]() {
+        std::vector<double> data(size);
+        for (uint64_t i = 1; i <= 2000; i++) {
+            std::fill(data.begin(), data.end(), double(i));
+            queue.push(data.data(), i, {});
+        }
+        queue.close();
+    });
+    visualize::frame out;
+    uint64_t last = 0;
+    while (queue.pop(out)) {
+        ASSERT_GT(out.sequence, last);
+        last = out.sequence;
+        for (size_t i = 0; i < size; i++) {
+            ASSERT_EQ(out.data[i], double(out.sequence)) << "merged into a frame that was being taken, bin " << i;
+        }
+    }
+    producer.join();
+    ASSERT_EQ(last, 2000u) << "the last frame merged is handed out before the queue counts as drained";
+    auto stats = queue.stats();
+    ASSERT_EQ(stats.pushed, 2000u);
+    ASSERT_EQ(stats.popped + stats.coalesced, 2000u);
+}
+
+TEST(frame_queue, catch_up) {
+    visualize::frame_queue queue(4, 1, visualize::overflow_policy::catch_up);
+    push_all(queue, { 1, 2, 3 });
+    visualize::frame out;
+    ASSERT_TRUE(queue.try_pop(out));
+    ASSERT_EQ(out.data[0], 3);
+    ASSERT_EQ(queue.stats().skipped, 2u);
+    ASSERT_FALSE(queue.try_pop(out));
+}
+
+TEST(frame_queue, features_travel_with_their_frame) {
+    visualize::frame_queue queue(2, 1, visualize::overflow_policy::coalesce_max);
+    visualize::spectral_features features[3];
+    for (uint64_t i = 0; i < 3; i++) {
+        features[i].flux = double(i + 1);
+        features[i].bpm = 100 + double(i);
+    }
+    features[1].onset = true;
+    double value = 0;
+    for (uint64_t i = 0; i < 3; i++) {
+        ASSERT_TRUE(queue.push(&value, i + 1, {}, features[i]));
+    }
+    visualize::frame out;
+    ASSERT_TRUE(queue.pop(out));
+    ASSERT_EQ(out.features.flux, 1);
+    ASSERT_FALSE(out.features.onset);
+    ASSERT_TRUE(queue.pop(out));
+    ASSERT_EQ(out.sequence, 3u);
+    ASSERT_EQ(out.features.flux, 3) << "a coalesced frame has the features of the newest frame merged into it";
+    ASSERT_EQ(out.features.bpm, 102);
+    ASSERT_TRUE(out.features.onset) << "onsets of merged frames aren't lost";
+}
+
+TEST(frame_queue, pipeline_publishes_features) {
+    const size_t resolution = 64;
+    visualize::generator_source::settings settings;
+    settings.kind = visualize::generator_source::signal::white_noise;
+    visualize::pipeline pipe(resolution, std::make_unique<visualize::generator_source>(resolution * 2, settings), {});
+    visualize::frame_queue queue(4, resolution);
+    pipe.set_output_queue(&queue);
+
+    std::vector<visualize::spectral_features> published;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(pipe.step());
+        auto [data, _] = pipe.output.acquire();
+        published.push_back(pipe.output.features);
+    }
+    visualize::frame out;
+    for (auto &expected : published) {
+        ASSERT_TRUE(queue.try_pop(out));
+        ASSERT_EQ(out.features.flux, expected.flux) << "frame " << out.sequence;
+        ASSERT_EQ(out.features.centroid, expected.centroid) << "frame " << out.sequence;
+        ASSERT_EQ(out.features.band_energy, expected.band_energy) << "frame " << out.sequence;
+    }
+}
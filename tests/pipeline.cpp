@@ -0,0 +1,189 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "data_sources/generator.hpp"
+#include "filters/clip_filter.hpp"
+#include "filters/peek_filter.hpp"
+#include "filters/sagc_filter.hpp"
+#include "pipeline.hpp"
+#include <algorithm>
+#include <functional>
+#include <gtest/gtest.h>
+
+namespace {
+    //! produces \p blocks blocks of a constant signal, then fails
+    struct constant_source : public visualize::data_source {
+        constant_source(size_t size, size_t blocks) : visualize::data_source(size), size(size), blocks(blocks) {}
+
+    private:
+        bool do_grab_audio(double *buf) override {
+            if (blocks == 0) {
+                return false;
+            }
+            blocks--;
+            std::fill_n(buf, size, 0.5);
+            return true;
+        }
+
+        size_t size;
+        size_t blocks;
+    };
+
+    //! overwrites every bin with \p value
+    struct fill_filter : public visualize::filter {
+        explicit fill_filter(size_t size, double value) : size(size), value(value) {}
+
+    private:
+        void do_apply(double *output) override { std::fill_n(output, size, value); }
+
+        size_t size;
+        double value;
+    };
+
+    std::vector<std::unique_ptr<visualize::filter>> fill_chain(size_t size, double value) {
+        std::vector<std::unique_ptr<visualize::filter>> chain;
+        chain.emplace_back(new fill_filter(size, value));
+        return chain;
+    }
+} // namespace
+
+TEST(pipeline, step) {
+    visualize::pipeline pipe(16, std::make_unique<constant_source>(32, 2), {});
+    ASSERT_TRUE(pipe.step());
+    ASSERT_TRUE(pipe.step());
+    {
+        auto [data, _] = pipe.output.acquire();
+        // all of the energy of a constant signal lands in the dc bin
+        ASSERT_GT(data[0], 0.0);
+        for (size_t i = 1; i < pipe.output.data_size; i++) {
+            ASSERT_NEAR(data[i], 0.0, 1e-9) << "bin " << i;
+        }
+    }
+    ASSERT_FALSE(pipe.step());
+    ASSERT_EQ(pipe.jitter().samples(), 1u);
+}
+
+TEST(pipeline, known_frequency) {
+    const size_t resolution = 256, barcount = 16, bin = 37;
+    visualize::generator_source::settings settings;
+    settings.kind = visualize::generator_source::signal::sine;
+    settings.frequency = double(bin) * settings.sample_rate / double(resolution * 2);
+    visualize::pipeline pipe(resolution, std::make_unique<visualize::generator_source>(resolution * 2, settings), {});
+    ASSERT_TRUE(pipe.step());
+
+    double bars[barcount];
+    {
+        auto [data, _] = pipe.output.acquire();
+        ASSERT_EQ(size_t(std::max_element(data, &data[resolution]) - data), bin);
+        visualize::calculate_bars(bars, barcount, data, resolution);
+    }
+    ASSERT_EQ(size_t(std::max_element(std::begin(bars), std::end(bars)) - std::begin(bars)),
+              bin / (resolution / barcount));
+}
+
+TEST(pipeline, set_filters) {
+    visualize::pipeline pipe(16, std::make_unique<constant_source>(32, 3), fill_chain(16, 1));
+    auto first_bin = [&pipe]() {
+        auto [data, _] = pipe.output.acquire();
+        return data[0];
+    };
+    ASSERT_TRUE(pipe.step());
+    ASSERT_EQ(first_bin(), 1);
+    // only the last of several chains set between two steps is used
+    pipe.set_filters(fill_chain(16, 2));
+    pipe.set_filters(fill_chain(16, 3));
+    ASSERT_EQ(first_bin(), 1) << "the chain changes with the next step";
+    ASSERT_TRUE(pipe.step());
+    ASSERT_EQ(first_bin(), 3);
+    pipe.set_filters({});
+    ASSERT_TRUE(pipe.step());
+    ASSERT_NE(first_bin(), 3);
+}
+
+TEST(pipeline, parallel_matches_serial) {
+    const size_t resolution = 1000;
+    auto chain = []() {
+        std::vector<std::unique_ptr<visualize::filter>> filters;
+        filters.emplace_back(new visualize::sagc_filter(resolution));
+        filters.emplace_back(new visualize::clip_filter(resolution));
+        // not partitionable, so it runs after the chunks
+        filters.emplace_back(new fill_filter(3, 0.25));
+        filters.emplace_back(new visualize::peek_filter(resolution, 100));
+        return filters;
+    };
+    visualize::generator_source::settings settings;
+    settings.kind = visualize::generator_source::signal::multitone;
+    settings.tones = { 440, 2000, 9000 };
+    visualize::worker_pool pool(3);
+    visualize::parallel_options parallel;
+    parallel.pool = &pool;
+    // the last chunk is shorter than the others
+    parallel.chunk_bins = 64;
+    visualize::pipeline serial(resolution, std::make_unique<visualize::generator_source>(resolution * 2, settings),
+                               chain());
+    visualize::pipeline split(resolution, std::make_unique<visualize::generator_source>(resolution * 2, settings),
+                              chain(), parallel);
+
+    for (int frame = 0; frame < 20; frame++) {
+        ASSERT_TRUE(serial.step());
+        ASSERT_TRUE(split.step());
+        auto [expected, lock] = serial.output.acquire();
+        auto [data, _] = split.output.acquire();
+        for (size_t i = 0; i < resolution; i++) {
+            ASSERT_NEAR(data[i], expected[i], 1e-9) << "frame " << frame << " bin " << i;
+        }
+        ASSERT_NEAR(split.output.features.flux, serial.output.features.flux, 1e-9);
+        ASSERT_NEAR(split.output.features.centroid, serial.output.features.centroid, 1e-9);
+        ASSERT_EQ(data[0], 0.25);
+    }
+}
+
+TEST(pipeline, parallel_step_on_a_busy_pool) {
+    const size_t resolution = 1000;
+    visualize::generator_source::settings settings;
+    visualize::worker_pool pool(1);
+    visualize::parallel_options parallel;
+    parallel.pool = &pool;
+    parallel.chunk_bins = 64;
+    visualize::pipeline pipe(resolution, std::make_unique<visualize::generator_source>(resolution * 2, settings),
+                             fill_chain(resolution, 1), parallel);
+
+    // stepped like the visualizer does, from a task that resubmits itself, so no worker is left to help
+    std::atomic_size_t steps = 0, leftover = 0;
+    std::atomic_bool done = false;
+    std::function<void()> step = [&]() {
+        if (!pipe.step()) {
+            done = true;
+            return;
+        }
+        leftover += pool.queued();
+        if (++steps < 16) {
+            pool.submit(step);
+        } else {
+            done = true;
+        }
+    };
+    pool.submit(step);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!done) {
+        ASSERT_LT(std::chrono::steady_clock::now(), deadline);
+        std::this_thread::yield();
+    }
+    ASSERT_EQ(steps.load(), 16u);
+    ASSERT_EQ(leftover.load(), 0u) << "help was queued where no worker takes it";
+    auto [data, _] = pipe.output.acquire();
+    ASSERT_EQ(data[resolution - 1], 1);
+}
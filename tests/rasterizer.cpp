@@ -0,0 +1,79 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "rasterizer.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+
+namespace {
+    constexpr uint32_t fg = 0xffffffff, bg = 0xff000000;
+    constexpr int width = 9, height = 8;
+
+    //! counts foreground pixels in column \p x, checking that they form a single bar standing on the bottom edge
+    int bar_height(const uint32_t *pixels, size_t pitch, int x) {
+        int h = 0;
+        for (int y = height - 1; y >= 0 && pixels[size_t(y) * pitch + size_t(x)] == fg; y--) {
+            h++;
+        }
+        for (int y = height - 1 - h; y >= 0; y--) {
+            EXPECT_EQ(pixels[size_t(y) * pitch + size_t(x)], bg) << "x " << x << " y " << y;
+        }
+        return h;
+    }
+} // namespace
+
+TEST(rasterizer, fill_row) {
+    uint32_t row[19] = {};
+    visualize::fill_row(&row[1], 17, 7);
+    ASSERT_EQ(row[0], 0u);
+    ASSERT_TRUE(std::all_of(&row[1], &row[18], [](auto p) { return p == 7; }));
+    ASSERT_EQ(row[18], 0u);
+}
+
+TEST(rasterizer, incremental_draw) {
+    // pitch is wider than the target to catch writes past the end of a row
+    const size_t pitch = 12;
+    uint32_t pixels[pitch * height];
+    std::fill(std::begin(pixels), std::end(pixels), 0);
+    visualize::rasterizer raster(fg, bg);
+    raster.target(pixels, pitch, width, height);
+    ASSERT_EQ(pixels[width], 0u) << "padding stays untouched";
+
+    std::vector<visualize::rasterizer::rect> dirty;
+    visualize::rasterizer::rect bars[] = { { 0, 3, 3, 5 }, { 3, 6, 3, 2 }, { 6, 8, 3, 0 } };
+    raster.draw(bars, std::size(bars), dirty);
+    ASSERT_EQ(bar_height(pixels, pitch, 0), 5);
+    ASSERT_EQ(bar_height(pixels, pitch, 4), 2);
+    ASSERT_EQ(bar_height(pixels, pitch, 8), 0);
+    ASSERT_EQ(dirty.size(), 2u);
+
+    bars[0] = { 0, 6, 3, 2 };
+    bars[1] = { 3, 0, 3, 8 };
+    raster.draw(bars, std::size(bars), dirty);
+    ASSERT_EQ(bar_height(pixels, pitch, 2), 2);
+    ASSERT_EQ(bar_height(pixels, pitch, 3), 8);
+    ASSERT_EQ(bar_height(pixels, pitch, 8), 0);
+    ASSERT_EQ(dirty.size(), 2u);
+    // only the rows between the old and new tops were touched
+    ASSERT_EQ(dirty[0].y, 3);
+    ASSERT_EQ(dirty[0].h, 3);
+    ASSERT_EQ(dirty[1].y, 0);
+    ASSERT_EQ(dirty[1].h, 6);
+
+    raster.draw(bars, std::size(bars), dirty);
+    ASSERT_TRUE(dirty.empty());
+    ASSERT_EQ(pixels[width], 0u);
+}
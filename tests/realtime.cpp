@@ -0,0 +1,36 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "realtime.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(realtime, jitter_histogram) {
+    using namespace std::chrono_literals;
+    visualize::jitter_histogram jitter;
+    for (int i = 0; i < 10; i++) {
+        jitter.record(10ms, 1ms);
+    }
+    ASSERT_EQ(jitter.samples(), 10u);
+    ASSERT_EQ(jitter.missed_deadlines(), 0u);
+
+    jitter.record(10ms, 15ms);
+    ASSERT_EQ(jitter.missed_deadlines(), 1u);
+
+    std::stringstream out;
+    jitter.print(out);
+    ASSERT_NE(out.str().find("< 1us: 11"), std::string::npos) << out.str();
+}
@@ -0,0 +1,89 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "settings.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <unistd.h>
+
+TEST(settings, read) {
+    std::istringstream file("# comment\n"
+                            "\n"
+                            "gravity = 20\n"
+                            "barcount=64\n"
+                            "  foreground = #ff8000  \n"
+                            "devices = default, alsa_output.monitor\n"
+                            "handoff_policy = catch_up\n"
+                            "handoff_format = log8\n"
+                            "realtime = yes\n"
+                            "realtime_policy = rr\n");
+    visualize::settings config;
+    ASSERT_TRUE(visualize::read_settings(file, "test", config));
+    ASSERT_EQ(config.gravity, 20);
+    ASSERT_EQ(config.barcount, 64u);
+    ASSERT_EQ(config.resolution, 2048u) << "missing keys keep their value";
+    ASSERT_EQ(config.foreground, (visualize::color { 255, 128, 0 }));
+    ASSERT_EQ(config.devices, (std::vector<std::string> { "", "alsa_output.monitor" }));
+    ASSERT_EQ(config.handoff_policy, visualize::overflow_policy::catch_up);
+    ASSERT_EQ(config.handoff_format, visualize::compact_format::log8);
+    ASSERT_TRUE(config.realtime);
+    ASSERT_EQ(config.realtime_policy, SCHED_RR);
+}
+
+TEST(settings, errors_keep_the_previous_values) {
+    visualize::settings config;
+    std::string error;
+    ASSERT_FALSE(config.set("barcount", "12abc", error));
+    ASSERT_FALSE(config.set("barcount", "-4", error));
+    ASSERT_FALSE(config.set("background", "#12345", error));
+    ASSERT_FALSE(config.set("handoff_policy", "newest", error));
+    ASSERT_FALSE(config.set("colour", "#000000", error));
+    ASSERT_EQ(error, "unknown setting \"colour\"");
+    ASSERT_EQ(config.barcount, 160u);
+
+    for (auto text : { "gravity = 20\nbarcount\n", "gravity = 20\nresolution = 64\nbarcount = 65\n" }) {
+        std::istringstream file(text);
+        ASSERT_FALSE(visualize::read_settings(file, "test", config)) << text;
+        ASSERT_EQ(config.gravity, 100.0 / 6.0) << "a file is applied completely or not at all";
+    }
+}
+
+TEST(settings, file_watcher) {
+    auto directory = std::filesystem::temp_directory_path() / ("settings-test-" + std::to_string(::getpid()));
+    std::filesystem::create_directories(directory);
+    auto path = (directory / "visualizer.conf").string();
+    {
+        visualize::file_watcher watcher(path);
+        ASSERT_TRUE(watcher.good());
+        ASSERT_FALSE(watcher.wait(std::chrono::milliseconds(0)));
+
+        std::ofstream(directory / "unrelated") << "x";
+        ASSERT_FALSE(watcher.wait(std::chrono::milliseconds(50)));
+
+        std::ofstream(path) << "gravity = 1\n";
+        ASSERT_TRUE(watcher.wait(std::chrono::milliseconds(1000)));
+        ASSERT_FALSE(watcher.wait(std::chrono::milliseconds(0))) << "events are consumed";
+
+        // editors that save atomically rename a new file over the old one
+        std::ofstream(directory / "visualizer.conf.tmp") << "gravity = 2\n";
+        std::filesystem::rename(directory / "visualizer.conf.tmp", path);
+        ASSERT_TRUE(watcher.wait(std::chrono::milliseconds(1000)));
+    }
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,72 @@
+/**
+ * Copyright 2019 w1d3m0d3
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "worker_pool.hpp"
+#include <gtest/gtest.h>
+#include <set>
+
+TEST(worker_pool, runs_all_tasks) {
+    std::atomic_size_t done = 0;
+    {
+        visualize::worker_pool pool(4);
+        for (size_t i = 0; i < 1000; i++) {
+            pool.submit([&done]() { done++; });
+        }
+    }
+    ASSERT_EQ(done.load(), 1000u);
+}
+
+TEST(worker_pool, idle_workers_steal) {
+    std::mutex lock;
+    std::set<std::thread::id> seen;
+    {
+        visualize::worker_pool pool(4);
+        // everything is submitted from inside one worker, so it lands in that worker's deque
+        pool.submit([&]() {
+            for (size_t i = 0; i < 64; i++) {
+                pool.submit([&]() {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                    std::lock_guard _(lock);
+                    seen.insert(std::this_thread::get_id());
+                });
+            }
+        });
+    }
+    ASSERT_GT(seen.size(), 1u);
+}
+
+TEST(worker_pool, try_submit_needs_a_sleeping_worker) {
+    std::atomic_bool release = false, ran = false;
+    visualize::worker_pool pool(1);
+    pool.submit([&]() {
+        while (!release) {
+            std::this_thread::yield();
+        }
+    });
+    // the only worker is busy, or woken for the task above
+    ASSERT_FALSE(pool.try_submit([]() {}));
+    release = true;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!pool.try_submit([&]() { ran = true; })) {
+        ASSERT_LT(std::chrono::steady_clock::now(), deadline);
+        std::this_thread::yield();
+    }
+    while (!ran) {
+        ASSERT_LT(std::chrono::steady_clock::now(), deadline);
+        std::this_thread::yield();
+    }
+    ASSERT_EQ(pool.queued(), 0u);
+}